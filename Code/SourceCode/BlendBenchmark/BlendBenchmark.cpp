@@ -0,0 +1,149 @@
+//Benchmarks the blend span kernels at each SIMD level against the scalar versions and a plain copy.
+//HAPI is only linked for Colour255. Pixels come from a fixed seed so runs on different commits do the same work.
+//
+//Usage: BlendBenchmark [--pixels N] [--out results.csv]
+//Every row also checks its output against the scalar kernel, matches is 0 if any pixel differs.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "BlendKernels.h"
+
+using namespace HAPISPACE;
+
+namespace
+{
+	//A ship sprite's width, a scaled tile and a full screen line
+	const int SPAN_LENGTHS[] = { 32, 256, 1600 };
+	const char* KERNEL_NAMES[] = { "alpha", "additive", "modulate", "tint" };
+	const char* LEVEL_NAMES[] = { "scalar", "sse2", "avx2" };
+
+	struct BenchmarkResult
+	{
+		std::string m_kernel;
+		std::string m_level;
+		int m_span;
+		unsigned long long m_pixels;
+		double m_nsPerPixel;
+		double m_speedup;
+		bool m_matches;
+	};
+
+	//Roughly what sprites hold, mostly solid or fully clear with some soft edges
+	std::vector<Colour255> makePixels(int count, std::mt19937& random)
+	{
+		std::vector<Colour255> pixels(count);
+		for (Colour255& pixel : pixels)
+		{
+			const int kind = random() % 4;
+			const BYTE alpha = kind == 0 ? 0 : kind == 1 ? (BYTE)(random() % 256) : 255;
+			pixel = Colour255((BYTE)(random() % 256), (BYTE)(random() % 256), (BYTE)(random() % 256), alpha);
+		}
+		return pixels;
+	}
+
+	//Blends the same source over a fresh copy of the destination span after span, the copy is timed too
+	//so it's taken off using the plain copy row
+	template<typename SpanFunction>
+	double timeSpans(std::vector<Colour255>& destination, const std::vector<Colour255>& original,
+		const std::vector<Colour255>& source, int span, int passes, SpanFunction blend)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < passes; pass++)
+		{
+			for (size_t offset = 0; offset + span <= destination.size(); offset += span)
+			{
+				memcpy(&destination[offset], &original[offset], span * sizeof(Colour255));
+				blend(&destination[offset], &source[offset], span);
+			}
+		}
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	const char* CSV_HEADER = "kernel,level,span,pixels,ns_per_pixel,speedup_vs_scalar,matches";
+
+	std::string toCsv(const BenchmarkResult& result)
+	{
+		char line[256];
+		snprintf(line, sizeof(line), "%s,%s,%d,%llu,%.3f,%.2f,%d", result.m_kernel.c_str(), result.m_level.c_str(),
+			result.m_span, result.m_pixels, result.m_nsPerPixel, result.m_speedup, result.m_matches ? 1 : 0);
+		return line;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int pixelCount = 1 << 16;
+	int totalPixels = 1 << 26;
+	std::string outFile;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		const std::string option = argv[i];
+		if (option == "--pixels")
+			totalPixels = std::max(pixelCount, std::atoi(argv[i + 1]));
+		else if (option == "--out")
+			outFile = argv[i + 1];
+	}
+
+	std::mt19937 random(46);
+	const std::vector<Colour255> source = makePixels(pixelCount, random);
+	const std::vector<Colour255> original = makePixels(pixelCount, random);
+	std::vector<Colour255> destination(pixelCount);
+	std::vector<Colour255> expected(pixelCount);
+	const Colour255 tint(40, 120, 255, 255);
+	const int passes = totalPixels / pixelCount;
+	const eSimdLevel supported = BlendKernels::getSupportedLevel();
+
+	std::vector<BenchmarkResult> results;
+	std::cout << "supported," << LEVEL_NAMES[supported] << std::endl << CSV_HEADER << std::endl;
+	for (int span : SPAN_LENGTHS)
+	{
+		const unsigned long long pixels = static_cast<unsigned long long>(passes) * (pixelCount / span) * span;
+		const double copyTime = timeSpans(destination, original, source, span, passes, [](Colour255*, const Colour255*, int) {});
+		results.push_back(BenchmarkResult{ "copy", "none", span, pixels, copyTime / pixels, 0.0, true });
+		std::cout << toCsv(results.back()) << std::endl;
+
+		for (int kernel = eBlendAlpha; kernel <= eBlendTint; kernel++)
+		{
+			double scalarTime = 0.0;
+			for (int level = eSimdScalar; level <= supported; level++)
+			{
+				const double time = timeSpans(destination, original, source, span, passes, [&](Colour255* dest, const Colour255* src, int num)
+				{
+					BlendKernels::blendSpan((eBlendKernel)kernel, dest, src, num, tint, (eSimdLevel)level);
+				});
+				if (level == eSimdScalar)
+				{
+					scalarTime = time;
+					expected = destination;
+				}
+
+				BenchmarkResult result;
+				result.m_kernel = KERNEL_NAMES[kernel];
+				result.m_level = LEVEL_NAMES[level];
+				result.m_span = span;
+				result.m_pixels = pixels;
+				result.m_nsPerPixel = time / pixels;
+				result.m_speedup = time > 0.0 ? scalarTime / time : 0.0;
+				result.m_matches = memcmp(destination.data(), expected.data(), pixelCount * sizeof(Colour255)) == 0;
+				results.push_back(result);
+				std::cout << toCsv(result) << std::endl;
+			}
+		}
+	}
+
+	if (!outFile.empty())
+	{
+		std::ofstream file(outFile);
+		file << CSV_HEADER << std::endl;
+		for (const BenchmarkResult& result : results)
+			file << toCsv(result) << std::endl;
+	}
+	return 0;
+}
@@ -3,7 +3,9 @@ del /s /q x64\Debug\*.*
 del /s /q .vs\*.*
 del /s /q HAPI_APP\x64\Release\*.*
 del /s /q HAPI_APP\x64\Debug\*.*
+del /s /q PathBenchmark\x64\*.*
 
 rd /s /q x64
 rd /s /q .vs
-rd /s /q HAPI_APP\x64
\ No newline at end of file
+rd /s /q HAPI_APP\x64
+rd /s /q PathBenchmark\x64
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "BandedRenderer.h"
+#include "DrawList.h"
+#include <algorithm>
+
+using namespace HAPISPACE;
+
+namespace
+{
+	//Bands thinner than this cost more to hand out than they save
+	constexpr int MIN_BAND_HEIGHT = 16;
+	//More bands than threads so a thread that gets a busy band doesn't hold the rest up
+	constexpr unsigned int BANDS_PER_THREAD = 2;
+}
+
+BandedRenderer::BandedRenderer(int width, int height, unsigned int threadCount) :
+	m_width(width),
+	m_bandHeight(height),
+	m_bands(),
+	m_workers(),
+	m_drawList(nullptr),
+	m_area(),
+	m_nextBand(0),
+	m_bandsLeft(0),
+	m_frame(0),
+	m_stopping(false)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	const int bandCount = std::max(1, std::min((int)(threadCount * BANDS_PER_THREAD), height / MIN_BAND_HEIGHT));
+	m_bandHeight = (height + bandCount - 1) / bandCount;
+	for (int band = 0; band < bandCount; band++)
+		m_bands.push_back(std::make_shared<Surface>(width, m_bandHeight));
+
+	for (unsigned int thread = 1; thread < threadCount; thread++)
+		m_workers.emplace_back(&BandedRenderer::workerLoop, this);
+}
+
+BandedRenderer::~BandedRenderer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_frameStarted.notify_all();
+	for (std::thread& worker : m_workers)
+		worker.join();
+}
+
+void BandedRenderer::workerLoop()
+{
+	unsigned int lastFrame = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_frameStarted.wait(lock, [&]() { return m_stopping || m_frame != lastFrame; });
+			if (m_stopping)
+				return;
+			lastFrame = m_frame;
+		}
+		drawBands();
+	}
+}
+
+void BandedRenderer::drawBands()
+{
+	for (int band = m_nextBand++; band < (int)m_bands.size(); band = m_nextBand++)
+	{
+		drawBand(band);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_bandsLeft == 0)
+			m_bandsFinished.notify_one();
+	}
+}
+
+void BandedRenderer::drawBand(int band)
+{
+	const int top = band * m_bandHeight;
+	RectangleI screenArea = m_area;
+	screenArea.ClipTo(RectangleI(0, m_width, top, top + m_bandHeight));
+	if (!screenArea.IsValid())
+		return;
+
+	Surface& surface = *m_bands[band];
+	const RectangleI bandArea = screenArea.Translated(0, -top);
+	const RectangleI oldClipArea = surface.SetClipArea(bandArea);
+	surface.DrawFilledRect(RectangleF((float)bandArea.left, (float)bandArea.right, (float)bandArea.top, (float)bandArea.bottom),
+		ColourFill(Colour255::BLACK));
+
+	for (const DrawCommand& command : m_drawList->getCommands())
+	{
+		if (command.getBounds().OutsideOf(screenArea))
+			continue;
+
+		Transform transform = command.m_transform;
+		transform.position.y -= top;
+		surface.Blit(command.m_surface, transform, command.m_area);
+	}
+	surface.SetClipArea(oldClipArea);
+}
+
+void BandedRenderer::render(DrawList& drawList, const std::shared_ptr<Surface>& target, RectangleI area)
+{
+	area.ClipTo(RectangleI(0, m_width, 0, m_bandHeight * (int)m_bands.size()));
+	if (!area.IsValid())
+		return;
+
+	drawList.sort();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_drawList = &drawList;
+		m_area = area;
+		m_bandsLeft = (int)m_bands.size();
+		m_nextBand = 0;
+		m_frame++;
+	}
+	m_frameStarted.notify_all();
+	drawBands();
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_bandsFinished.wait(lock, [&]() { return m_bandsLeft == 0; });
+	}
+
+	for (int band = 0; band < (int)m_bands.size(); band++)
+	{
+		const int top = band * m_bandHeight;
+		RectangleI screenArea = area;
+		screenArea.ClipTo(RectangleI(0, m_width, top, top + m_bandHeight));
+		if (screenArea.IsValid())
+		{
+			target->Blit(m_bands[band], Transform(VectorF((float)screenArea.left, (float)screenArea.top)),
+				screenArea.Translated(0, -top), EBlendMode::eReplace);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <HAPISprites_lib.h>
+
+class DrawList;
+
+//Draws a sorted draw list across several threads. The screen is split into horizontal bands, each with its own surface,
+//and every thread takes bands until none are left, drawing only the commands that reach into them.
+//Finished bands are copied to the target in one pass, so threads never write to the same texels.
+//HAPI's blits only read the surfaces drawn from, so threads can share them.
+class BandedRenderer
+{
+private:
+	int m_width;
+	int m_bandHeight;
+	std::vector<std::shared_ptr<HAPISPACE::Surface>> m_bands;
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_frameStarted;
+	std::condition_variable m_bandsFinished;
+	//The frame being drawn, only changed while no bands are being drawn
+	const DrawList* m_drawList;
+	HAPISPACE::RectangleI m_area;
+	std::atomic<int> m_nextBand;
+	int m_bandsLeft;
+	unsigned int m_frame;
+	bool m_stopping;
+
+	void workerLoop();
+	//Draws bands until there are none left to take, the rendering thread helps too
+	void drawBands();
+	void drawBand(int band);
+public:
+	//threadCount 0 uses every core, 1 draws everything on the calling thread
+	BandedRenderer(int width, int height, unsigned int threadCount = 0);
+	~BandedRenderer();
+	BandedRenderer(const BandedRenderer&) = delete;
+	BandedRenderer& operator=(const BandedRenderer&) = delete;
+
+	//Draws the part of the list inside area over that area of the target, whatever was there is replaced
+	void render(DrawList& drawList, const std::shared_ptr<HAPISPACE::Surface>& target, HAPISPACE::RectangleI area);
+};
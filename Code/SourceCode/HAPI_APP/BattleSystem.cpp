@@ -1,19 +1,71 @@
 #include "BattleSystem.h"
 #include "Utilities/MapParser.h"
+#include <algorithm>
+#include <math.h>
+
+//Tiles across each chunk of the sea lane graph
+constexpr int SEA_LANE_CHUNK_SIZE = 10;
+//Voyages further than this many tiles follow the sea lane graph rather than a search over every tile
+constexpr int SEA_LANE_MIN_DISTANCE = 20;
 ////////////////////////////////////////////////////////
 //move all code out of main into here
 // build stage to here to place an entity 
 //set move stage 
 ///////////////////////////////////////////////////////
 
+BattleSystem::BattleInput::BattleInput() :
+	m_clickedTiles(),
+	m_tileChanges(),
+	m_shipPositions(),
+	m_reachability(),
+	m_movesTaken(0)
+{
+}
+
 BattleSystem::BattleSystem() : 
 	m_map(MapParser::parseMap("Data\\Level1.tmx")),
+	m_minimap(m_map),
+	m_baseDrawScale(m_map.getDrawScale()),
+	m_dirtyRegions(RectangleI(SCREEN_SURFACE->Width(), SCREEN_SURFACE->Height())),
+	m_lastDrawScale(0.0f),
+	m_lastDrawOffset(0, 0),
+	m_drawList(),
+	m_drawOrder(m_map.getMapDimensions().first),
+	m_renderer(SCREEN_SURFACE->Width(), SCREEN_SURFACE->Height()),
+	m_tileChanges(),
+	m_movesTaken(0),
+	m_turnFaction(faction::eFaction1),
+	m_reachability(),
+	m_reachabilityChanged(false),
+	m_moveMarker(HAPI_Sprites.LoadSprite("Data\\mouseCrossHair.xml")),
+	m_moveMarkerAreas(),
 	UIWind(),
-	entityPositionInVector(0),
-	coord(std::pair<int, int>(0, 0))
+	m_simulationGrid(m_map.getPathGrid()),
+	m_pathSearches(m_simulationGrid),
+	m_seaLanes(m_simulationGrid, SEA_LANE_CHUNK_SIZE),
+	m_voyagePaths(m_simulationGrid),
+	m_shipPositions(),
+	m_simulationReachability(),
+	m_voyages(),
+	m_unappliedMoves(),
+	m_movesPublished(0),
+	m_selectedShip(-1),
+	m_simulationThread(),
+	m_simulationMutex(),
+	m_inputChanged(),
+	m_pendingInput(),
+	m_inputPending(false),
+	m_finishedMoves(),
+	m_shownSelection(-1),
+	m_stopSimulation(false)
 {
+	m_map.addListener(&m_minimap);
+	m_map.addListener(this);
+	m_dirtyRegions.addOverlay(DirtyRegionTracker::FPS_COUNTER_AREA);
+
 	Entity* testShip = new Entity("Data\\mouseCrossHair.xml");
 	Entity* testShip2 = new Entity("Data\\thingy.xml");
+	testShip2->setFaction(faction::eFaction2);
 	m_entities.push_back(std::pair<Entity*, std::pair<int, int> >(testShip, std::pair<int, int>(4, 4)));
 	m_entities.push_back(std::pair<Entity*, std::pair<int, int> >(testShip2, std::pair<int, int>(5, 5)));
 
@@ -22,13 +74,15 @@ BattleSystem::BattleSystem() :
 	{
 		m_map.insertEntity(i.first, i.second);
 	}
-	
-	
+
+
 }
 
 
 BattleSystem::~BattleSystem()
 {
+	m_map.removeListener(&m_minimap);
+	m_map.removeListener(this);
 	for (auto it : m_entities)
 	{
 		delete it.first;
@@ -36,51 +90,448 @@ BattleSystem::~BattleSystem()
 	m_entities.clear();
 }
 
-void BattleSystem::update()
+void BattleSystem::readInput(BattleInput& input)
 {
-	std::pair<float,float> tempTileLocation;
-	
-	SCREEN_SURFACE->Clear();
-		
-	m_map.drawMap();
+	m_map.setDrawScale(m_baseDrawScale * UIWind.getCameraZoom());
+	if (m_map.getDrawScale() != m_lastDrawScale || m_map.getDrawOffset() != m_lastDrawOffset)
+	{
+		m_dirtyRegions.markAllDirty();
+		m_lastDrawScale = m_map.getDrawScale();
+		m_lastDrawOffset = m_map.getDrawOffset();
+	}
+	m_map.updateTileSprites();
 	UIWind.Update();
+	for (const std::unique_ptr<Sprite>& sprite : UIWind.storage)
+		m_dirtyRegions.trackSprite(*sprite);
+
+	//Only tiles on screen can be clicked or have a ship to draw
+	const TileRange visible = m_map.getVisibleTileRange();
+	for (int row = visible.m_first.second; row <= visible.m_last.second; row++)
+	{
+		for (int column = visible.m_first.first; column <= visible.m_last.first; column++)
+		{
+			Tile& tile = m_map.getMap()->data()[column + row * m_map.getMapDimensions().first]; // temp these 2 vectors not gonna be public had to get test working
+			UIWind.HandleCollision(*UIWind.storage[UIWind.storage.size() - 1], *tile.m_sprite);
+			if (UIWind.takeTileClicked())
+				input.m_clickedTiles.push_back(tile.m_tileCoordinate);
+
+			if (tile.m_entityOnTile != nullptr)
+			{
+				tile.m_entityOnTile->getSprite().GetTransformComp().SetPosition({ tile.m_sprite->GetTransformComp().GetPosition().x + 30, tile.m_sprite->GetTransformComp().GetPosition().y + 40 });
+			}
+		}
+	}
+}
+
+void BattleSystem::sendInput(BattleInput& input)
+{
+	input.m_tileChanges.swap(m_tileChanges);
+	m_tileChanges.clear();
+	if (input.m_clickedTiles.empty() && input.m_tileChanges.empty() && !m_reachabilityChanged)
+		return;
+
+	//Ships only change where they are through tile changes, so they are only sent along with something else
+	for (const auto& entity : m_entities)
+		input.m_shipPositions.push_back(entity.second);
+	if (m_reachabilityChanged)
+		input.m_reachability = m_reachability;
+	m_reachabilityChanged = false;
+	input.m_movesTaken = m_movesTaken;
+
+	{
+		std::lock_guard<std::mutex> lock(m_simulationMutex);
+		m_pendingInput.m_clickedTiles.insert(m_pendingInput.m_clickedTiles.end(), input.m_clickedTiles.begin(), input.m_clickedTiles.end());
+		m_pendingInput.m_tileChanges.insert(m_pendingInput.m_tileChanges.end(), input.m_tileChanges.begin(), input.m_tileChanges.end());
+		m_pendingInput.m_shipPositions.swap(input.m_shipPositions);
+		if (input.m_reachability)
+			m_pendingInput.m_reachability = input.m_reachability;
+		m_pendingInput.m_movesTaken = input.m_movesTaken;
+		m_inputPending = true;
+	}
+	m_inputChanged.notify_all();
+}
+
+void BattleSystem::applyMoves()
+{
+	std::vector<ShipMove> moves;
+	{
+		std::lock_guard<std::mutex> lock(m_simulationMutex);
+		moves.swap(m_finishedMoves);
+	}
+	//A move the map turns down leaves the ship where it was, and the simulation sees that with the next input
+	bool moved = false;
+	for (const ShipMove& move : moves)
+	{
+		if (m_map.moveEntity(move.m_from, move.m_to))
+		{
+			Entity* ship = m_entities[move.m_ship].first;
+			ship->setMovementPoints(ship->getMovementPoints() - move.m_cost);
+			m_entities[move.m_ship].second = move.m_to;
+			moved = true;
+		}
+	}
+	m_movesTaken += (int)moves.size();
+	if (moved)
+		buildReachability();
+}
+
+void BattleSystem::startTurn(faction turnFaction)
+{
+	m_turnFaction = turnFaction;
+	for (const auto& entity : m_entities)
+	{
+		if (entity.first->getFaction() == turnFaction)
+			entity.first->setMovementPoints(entity.first->getMaxMovementPoints());
+	}
+	buildReachability();
+}
 
-	for (int x = 0; x < m_map.getMap()->size(); x++) // temp these 2 vectors not gonna be public had to get test working 
+void BattleSystem::endTurn()
+{
+	for (int next = 1; next <= FACTION_COUNT; next++)
 	{
-		UIWind.HandleCollision(*UIWind.storage[UIWind.storage.size() - 1], *m_map.getMap()->data()[x].m_sprite);
-		tempTileLocation = std::pair<float, float>(m_map.getMap()->data()[x].m_sprite->GetTransformComp().GetPosition().x, m_map.getMap()->data()[x].m_sprite->GetTransformComp().GetPosition().y);
-		
-		if (tempTileLocation == UIWind.tilePos)
+		const faction nextFaction = static_cast<faction>((static_cast<int>(m_turnFaction) + next) % FACTION_COUNT);
+		for (const auto& entity : m_entities)
 		{
-				coord = m_map.getMap()->data()[x].m_tileCoordinate;
+			if (entity.first->getFaction() == nextFaction)
+			{
+				startTurn(nextFaction);
+				return;
+			}
+		}
+	}
+}
+
+void BattleSystem::buildReachability()
+{
+	m_reachability = TurnReachability::build(m_map, m_turnFaction);
+	m_reachabilityChanged = true;
+}
+
+void BattleSystem::drawMovePreview(const TileRange& visible)
+{
+	int selected;
+	{
+		std::lock_guard<std::mutex> lock(m_simulationMutex);
+		selected = m_shownSelection;
+	}
+	//Only ships whose turn it is have reachability
+	const ReachabilityMap* reachability = selected != -1 && m_reachability ? m_reachability->find(m_entities[selected].second) : nullptr;
+
+	std::vector<RectangleI> areas;
+	if (reachability)
+	{
+		for (std::pair<int, int> tile : reachability->getTiles())
+		{
+			if (tile == m_entities[selected].second || tile.first < visible.m_first.first || tile.first > visible.m_last.first ||
+				tile.second < visible.m_first.second || tile.second > visible.m_last.second)
+				continue;
+
+			const Sprite& tileSprite = *m_map.getTile(tile)->m_sprite;
+			const std::pair<int, int> screenPos = m_map.getTileScreenPos(tile);
+			const int left = screenPos.first + (int)(tileSprite.FrameWidth() * m_map.getDrawScale() - m_moveMarker->FrameWidth()) / 2;
+			const int top = screenPos.second + (int)(tileSprite.FrameHeight() * m_map.getDrawScale() - m_moveMarker->FrameHeight()) / 2;
+			m_moveMarker->GetTransformComp().SetPosition(VectorF((float)left, (float)top));
+			//Under every ship, which start from depth 0
+			m_drawList.add(eLayerShips, -1.0f, *m_moveMarker);
+			areas.push_back(RectangleI(left - 1, left + m_moveMarker->FrameWidth() + 1, top - 1, top + m_moveMarker->FrameHeight() + 1));
 		}
-			
-		for (int x = 0; x < m_entities.size(); x++)
+	}
+
+	//The markers aren't tracked as sprites, so where they were and are now is redrawn whenever the preview changes
+	if (areas != m_moveMarkerAreas)
+	{
+		for (const RectangleI& area : m_moveMarkerAreas)
+			m_dirtyRegions.markDirty(area);
+		for (const RectangleI& area : areas)
+			m_dirtyRegions.markDirty(area);
+		m_moveMarkerAreas.swap(areas);
+	}
+}
+
+void BattleSystem::draw(const TileRange& visible)
+{
+	//Ships off screen aren't drawn, so are tracked as hidden
+	for (const auto& entity : m_entities)
+	{
+		const bool onScreen = entity.second.first >= visible.m_first.first && entity.second.first <= visible.m_last.first &&
+			entity.second.second >= visible.m_first.second && entity.second.second <= visible.m_last.second;
+		m_dirtyRegions.trackSprite(entity.first->getSprite(), onScreen);
+	}
+	if (m_minimap.takeChanged())
+	{
+		const std::pair<int, int> position = getMinimapPosition();
+		m_dirtyRegions.markDirty(RectangleI(position.first, position.first + m_minimap.getSize().first,
+			position.second, position.second + m_minimap.getSize().second));
+	}
+
+	m_drawList.clear();
+	m_map.drawMap(m_drawList);
+	//Ships go in their tile's slot of the draw order, so lower ships cover higher ones the same way tiles do
+	const std::vector<int>& order = m_drawOrder.getOrder(visible);
+	for (size_t slot = 0; slot < order.size(); slot++)
+	{
+		Entity* entity = m_map.getMap()->data()[order[slot]].m_entityOnTile;
+		if (entity)
+			m_drawList.add(eLayerShips, (float)slot, entity->getSprite());
+	}
+	drawMovePreview(visible);
+	m_minimap.draw(m_drawList, getMinimapPosition());
+	UIWind.Render(m_drawList);
+	m_drawList.sort();
+}
+
+std::pair<int, int> BattleSystem::getMinimapPosition() const
+{
+	const int margin = 10;
+	return std::pair<int, int>(SCREEN_SURFACE->Width() - m_minimap.getSize().first - margin,
+		SCREEN_SURFACE->Height() - m_minimap.getSize().second - margin);
+}
+
+void BattleSystem::render()
+{
+	m_dirtyRegions.redraw(SCREEN_SURFACE, [&](const RectangleI& area) { m_renderer.render(m_drawList, SCREEN_SURFACE, area); });
+}
+
+void BattleSystem::onTileChanged(std::pair<int, int> coord, eTileChange change)
+{
+	const int index = m_map.getPathGrid().getIndex(coord);
+	m_tileChanges.push_back(TileChange{ coord, change, m_map.getPathGrid().getType(index), m_map.getPathGrid().isOccupied(index) });
+
+	//Ships moving are tracked through their sprites, only terrain needs redrawing here
+	if (change != eTerrainChange)
+		return;
+
+	const Sprite& tileSprite = *m_map.getTile(coord)->m_sprite;
+	const std::pair<int, int> screenPos = m_map.getTileScreenPos(coord);
+	m_dirtyRegions.markDirty(RectangleI(screenPos.first - 1, screenPos.first + (int)ceil(tileSprite.FrameWidth() * m_map.getDrawScale()) + 1,
+		screenPos.second - 1, screenPos.second + (int)ceil(tileSprite.FrameHeight() * m_map.getDrawScale()) + 1));
+}
+
+void BattleSystem::simulationLoop()
+{
+	BattleInput input;
+	while (true)
+	{
+		bool inputTaken = false;
 		{
-			if (m_entities[x].second == coord)
+			//Searches still running carry on without waiting for input
+			std::unique_lock<std::mutex> lock(m_simulationMutex);
+			m_inputChanged.wait(lock, [&]() { return m_inputPending || m_stopSimulation || isSearching(); });
+			if (m_stopSimulation)
+				return;
+
+			if (m_inputPending)
 			{
-				entityPositionInVector = x;
+				input = BattleInput();
+				std::swap(input, m_pendingInput);
+				m_inputPending = false;
+				inputTaken = true;
 			}
 		}
-			
-		if (m_map.moveEntity(std::pair<int, int>(m_entities[entityPositionInVector].second), coord))
+		if (inputTaken)
+			takeInput(input);
+		m_pathSearches.update();
+		advanceVoyages();
+	}
+}
+
+void BattleSystem::takeInput(const BattleInput& input)
+{
+	applyTileChanges(input.m_tileChanges);
+	if (input.m_reachability)
+		m_simulationReachability = input.m_reachability;
+	//Moves the main thread hadn't taken when it read the ships are made again on top of them
+	m_shipPositions = input.m_shipPositions;
+	const int taken = input.m_movesTaken - (m_movesPublished - (int)m_unappliedMoves.size());
+	m_unappliedMoves.erase(m_unappliedMoves.begin(), m_unappliedMoves.begin() + taken);
+	for (const ShipMove& move : m_unappliedMoves)
+		m_shipPositions[move.m_ship] = move.m_to;
+	for (std::pair<int, int> coord : input.m_clickedTiles)
+		handleClick(coord);
+}
+
+void BattleSystem::applyTileChanges(const std::vector<TileChange>& changes)
+{
+	for (const TileChange& change : changes)
+	{
+		const int index = m_simulationGrid.getIndex(change.m_coord);
+		m_simulationGrid.setType(index, change.m_type);
+		m_simulationGrid.setOccupied(index, change.m_occupied);
+		m_seaLanes.onTileChanged(change.m_coord, change.m_change);
+		m_voyagePaths.onTileChanged(change.m_coord, change.m_change);
+	}
+}
+
+void BattleSystem::handleClick(std::pair<int, int> coord)
+{
+	const int ship = findShip(coord);
+	if (ship != -1)
+	{
+		selectShip(ship);
+		return;
+	}
+	if (m_selectedShip == -1 || !m_simulationReachability)
+		return;
+
+	//Ships can only be given orders on their own turn. Tiles out of reach are sailed to over the turns to come.
+	const std::pair<int, int> from = m_shipPositions[m_selectedShip];
+	const ReachabilityMap* reachability = m_simulationReachability->find(from);
+	if (!reachability)
+		return;
+
+	cancelVoyage(m_selectedShip);
+	if (reachability->isReachable(coord))
+		publishMove(ShipMove{ m_selectedShip, from, coord, reachability->getCost(coord) });
+	else
+		orderVoyage(m_selectedShip, coord);
+}
+
+void BattleSystem::selectShip(int ship)
+{
+	m_selectedShip = ship;
+	std::lock_guard<std::mutex> lock(m_simulationMutex);
+	m_shownSelection = ship;
+}
+
+void BattleSystem::orderVoyage(int ship, std::pair<int, int> dest)
+{
+	const std::pair<int, int> from = m_shipPositions[ship];
+	if (PathGrid::getDistance(from, dest) > SEA_LANE_MIN_DISTANCE)
+	{
+		std::vector<std::pair<int, int>> route = m_seaLanes.findPath(from, dest);
+		if (!route.empty())
+			m_voyages.push_back(Voyage{ ship, -1, std::move(route) });
+		return;
+	}
+	//Ships in the way now will most likely have moved by the time it gets there
+	m_voyages.push_back(Voyage{ ship, m_pathSearches.startSearch(from, dest, eIgnoreShips), std::vector<std::pair<int, int>>() });
+}
+
+void BattleSystem::cancelVoyage(int ship)
+{
+	for (auto it = m_voyages.begin(); it != m_voyages.end(); ++it)
+	{
+		if (it->m_ship == ship)
+		{
+			if (it->m_searchId != -1)
+				m_pathSearches.cancelSearch(it->m_searchId);
+			m_voyages.erase(it);
+			return;
+		}
+	}
+}
+
+void BattleSystem::advanceVoyages()
+{
+	for (auto it = m_voyages.begin(); it != m_voyages.end();)
+	{
+		if (it->m_searchId != -1)
 		{
-			m_entities[entityPositionInVector].second = coord;
+			const TimeSlicedSearch* search = m_pathSearches.getSearch(it->m_searchId);
+			if (!search->isDone())
+			{
+				++it;
+				continue;
+			}
+			if (search->getStatus() == eSearchFound)
+				it->m_route = search->getBestPath();
+			m_pathSearches.cancelSearch(it->m_searchId);
+			it->m_searchId = -1;
 		}
 
-		if (m_map.getMap()->data()[x].m_entityOnTile != nullptr)
+		if (sailVoyage(*it))
+			++it;
+		else
+			it = m_voyages.erase(it);
+	}
+}
+
+bool BattleSystem::sailVoyage(Voyage& voyage)
+{
+	const std::pair<int, int> position = m_shipPositions[voyage.m_ship];
+	const auto here = std::find(voyage.m_route.begin(), voyage.m_route.end(), position);
+	if (here == voyage.m_route.end() || here + 1 == voyage.m_route.end())
+		return false;
+
+	//No reachability for the ship's position until its turn comes round, or until the map has made its last move
+	const ReachabilityMap* reachability = m_simulationReachability ? m_simulationReachability->find(position) : nullptr;
+	if (!reachability)
+		return true;
+
+	for (auto stop = voyage.m_route.end() - 1; stop != here; --stop)
+	{
+		if (reachability->isReachable(*stop))
 		{
-			m_map.getMap()->data()[x].m_entityOnTile->getSprite().GetTransformComp().SetPosition({ m_map.getMap()->data()[x].m_sprite->GetTransformComp().GetPosition().x + 30, m_map.getMap()->data()[x].m_sprite->GetTransformComp().GetPosition().y + 40 });
-			m_map.getMap()->data()[x].m_entityOnTile->render();
+			publishMove(ShipMove{ voyage.m_ship, position, *stop, reachability->getCost(*stop) });
+			return true;
 		}
-			
 	}
+
+	//Nothing ahead in reach and a ship on the next tile, so sail around it. If there's no way around it waits for the ship to move.
+	if (!m_simulationGrid.isOccupied(m_simulationGrid.getIndex(*(here + 1))))
+		return true;
+	std::vector<std::pair<int, int>> detour = m_voyagePaths.findCachedPath(m_simulationGrid, position, voyage.m_route.back(), eAvoidShips);
+	if (detour.empty())
+		return true;
+	std::reverse(detour.begin(), detour.end());
+	voyage.m_route = std::move(detour);
+	return sailVoyage(voyage);
+}
+
+bool BattleSystem::isSearching() const
+{
+	for (const Voyage& voyage : m_voyages)
+	{
+		if (voyage.m_searchId != -1)
+			return true;
+	}
+	return false;
+}
+
+int BattleSystem::findShip(std::pair<int, int> coord) const
+{
+	for (int ship = 0; ship < (int)m_shipPositions.size(); ship++)
+	{
+		if (m_shipPositions[ship] == coord)
+			return ship;
+	}
+	return -1;
+}
+
+void BattleSystem::publishMove(const ShipMove& move)
+{
+	m_shipPositions[move.m_ship] = move.m_to;
+	m_unappliedMoves.push_back(move);
+	m_movesPublished++;
+	std::lock_guard<std::mutex> lock(m_simulationMutex);
+	m_finishedMoves.push_back(move);
 }
 
 void BattleSystem::run()
 {
+	//Input arrives through callbacks inside HAPI_Sprites.Update, so it is read straight after. The simulation
+	//catches up with it in its own time and the frame is drawn from whatever it had finished by then.
+	m_stopSimulation = false;
+	m_simulationThread = std::thread(&BattleSystem::simulationLoop, this);
+	startTurn(faction::eFaction1);
+
 	while (HAPI_Sprites.Update()) //Why are there two while loops nested! (Here and one in update)
 	{
-		update();
+		applyMoves();
+		if (UIWind.takeEndTurn())
+			endTurn();
+		BattleInput input;
+		readInput(input);
+		sendInput(input);
+		draw(m_map.getVisibleTileRange());
+		render();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_simulationMutex);
+		m_stopSimulation = true;
 	}
+	m_inputChanged.notify_all();
+	m_simulationThread.join();
 }
\ No newline at end of file
@@ -1,28 +1,167 @@
 #pragma once
 
 #include <HAPISprites_lib.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <utility>
+#include "BandedRenderer.h"
+#include "DirtyRegionTracker.h"
+#include "DrawList.h"
 #include "Entity.h"
+#include "HexDrawOrder.h"
 #include "Map.h"
+#include "HierarchicalPathfinding.h"
+#include "Minimap.h"
+#include "Pathfinding.h"
+#include "TimeSlicedSearch.h"
+#include "TurnReachability.h"
 #include "UIClass.h"
 
 
 using namespace HAPISPACE;
 
-class BattleSystem
+//Input, sprites, the map and drawing belong to the main thread. Game logic runs on the simulation thread from copies
+//of what it needs, sent as a BattleInput, and hands back ship moves for the main thread to make. Neither waits for the other.
+class BattleSystem : public IMapListener
 {
 private:
-	void update();
+	//A tile after it changed, so the simulation's copy of the path grid keeps up with the map
+	struct TileChange
+	{
+		std::pair<int, int> m_coord;
+		eTileChange m_change;
+		eTileType m_type;
+		bool m_occupied;
+	};
+	//Everything the main thread has read since the simulation last took its input
+	struct BattleInput
+	{
+		BattleInput();
+
+		std::vector<std::pair<int, int>> m_clickedTiles;
+		std::vector<TileChange> m_tileChanges;
+		std::vector<std::pair<int, int>> m_shipPositions;
+		//Only set when it was built again, as it is shared rather than copied
+		std::shared_ptr<const TurnReachability> m_reachability;
+		//Moves the main thread had taken when the ships were read, made or turned down
+		int m_movesTaken;
+	};
+	//m_ship is the ship's index in m_entities
+	struct ShipMove
+	{
+		int m_ship;
+		std::pair<int, int> m_from;
+		std::pair<int, int> m_to;
+		float m_cost;
+	};
+	//A ship on its way to a tile it can't reach this turn, sailing as far along the route as it can each turn
+	struct Voyage
+	{
+		int m_ship;
+		//-1 once the route is known
+		int m_searchId;
+		//Start first
+		std::vector<std::pair<int, int>> m_route;
+	};
+
+	//Main thread
+	//Moves the camera and cursor, finds clicked tiles and places the ship sprites
+	void readInput(BattleInput& input);
+	//Adds the ships and this frame's tile changes, then hands the input over without waiting
+	void sendInput(BattleInput& input);
+	//Makes the moves the simulation has finished since last frame
+	void applyMoves();
+	//Gives the faction's ships their movement points back and works out where they can all go
+	void startTurn(faction turnFaction);
+	//Starts the turn of the next faction that has ships
+	void endTurn();
+	void buildReachability();
+	//Marks every tile the selected ship can reach this turn
+	void drawMovePreview(const TileRange& visible);
+	void draw(const TileRange& visible);
+	void render();
+	//Bottom right corner of the screen
+	std::pair<int, int> getMinimapPosition() const;
+
+	//Simulation thread
+	void simulationLoop();
+	void takeInput(const BattleInput& input);
+	void applyTileChanges(const std::vector<TileChange>& changes);
+	void handleClick(std::pair<int, int> coord);
+	void selectShip(int ship);
+	void orderVoyage(int ship, std::pair<int, int> dest);
+	void cancelVoyage(int ship);
+	//Takes the routes of finished searches and sails each ship with a route on to the furthest tile of it in reach
+	void advanceVoyages();
+	//False once the voyage is over
+	bool sailVoyage(Voyage& voyage);
+	bool isSearching() const;
+	//Index of the ship on the tile or -1
+	int findShip(std::pair<int, int> coord) const;
+	void publishMove(const ShipMove& move);
 
 	std::vector<std::pair<Entity*, std::pair<int, int>>> m_entities;
 	Map m_map;
+	//Patched from tile changes rather than redrawn from the map
+	Minimap m_minimap;
+	//Map draw scale at a camera zoom of 1
+	float m_baseDrawScale;
+	//Only the parts of the screen that changed are drawn again, the camera moving redraws everything
+	DirtyRegionTracker m_dirtyRegions;
+	float m_lastDrawScale;
+	std::pair<int, int> m_lastDrawOffset;
+	DrawList m_drawList;
+	//Visible tiles in the order they are drawn, ships are drawn in the same order
+	HexDrawOrder m_drawOrder;
+	//Draws the draw list on every core, a band of the screen at a time
+	BandedRenderer m_renderer;
+	//Tile changes since input was last sent
+	std::vector<TileChange> m_tileChanges;
+	int m_movesTaken;
+	faction m_turnFaction;
+	//Where the ships whose turn it is can move, built at the start of the turn and again after any of them moves
+	std::shared_ptr<const TurnReachability> m_reachability;
+	bool m_reachabilityChanged;
+	std::unique_ptr<Sprite> m_moveMarker;
+	//Screen areas of the markers drawn last frame
+	std::vector<RectangleI> m_moveMarkerAreas;
 	UIWindowTest UIWind;
-	std::pair<int, int>coord;
-	int entityPositionInVector;
-	
+
+	//Simulation thread, its grid is only changed from the tile changes it is sent
+	PathGrid m_simulationGrid;
+	//Voyage routes, searched a budget at a time so input keeps being taken while they run
+	PathSearchScheduler m_pathSearches;
+	//Coarse graph of the sea lanes, routes the longest voyages in one go
+	HierarchicalPathfinding m_seaLanes;
+	//Routes around ships blocking a voyage. A ship stays blocked for many inputs, so the same route is asked for again and again.
+	Pathfinding m_voyagePaths;
+	//Positions as of the last input, with the simulation's own moves made on top
+	std::vector<std::pair<int, int>> m_shipPositions;
+	std::shared_ptr<const TurnReachability> m_simulationReachability;
+	std::vector<Voyage> m_voyages;
+	//Moves published that the ships last sent didn't include yet, in order
+	std::vector<ShipMove> m_unappliedMoves;
+	int m_movesPublished;
+	int m_selectedShip;
+
+	//Shared, guarded by the mutex
+	std::thread m_simulationThread;
+	std::mutex m_simulationMutex;
+	std::condition_variable m_inputChanged;
+	//Input sent before the simulation took the last lot is added to it, so nothing is dropped and nothing waits
+	BattleInput m_pendingInput;
+	bool m_inputPending;
+	std::vector<ShipMove> m_finishedMoves;
+	//The simulation's selected ship, for the main thread to show
+	int m_shownSelection;
+	bool m_stopSimulation;
+
 public:
 	BattleSystem();
 	~BattleSystem();
 	void run();
+	void onTileChanged(std::pair<int, int> coord, eTileChange change) override;
 };
\ No newline at end of file
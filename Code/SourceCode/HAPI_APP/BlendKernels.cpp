@@ -0,0 +1,333 @@
+#include "BlendKernels.h"
+#include <algorithm>
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+//MSVC allows AVX2 intrinsics in any function, the CPU is checked before they are called
+#define AVX2_FUNCTION
+#else
+#include <cpuid.h>
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+
+using namespace HAPISPACE;
+
+namespace
+{
+	typedef void(*SpanFunction)(Colour255* destination, const Colour255* source, int num, Colour255 tint);
+
+	//x / 255 rounded to nearest, exact for anything up to 255 * 255
+	inline int div255(int x)
+	{
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+
+	//Scalar versions, also used for the pixels left over at the end of a span by the wide ones
+
+	//Alpha blends as if the source alpha channel were 255, so the result's alpha is the usual "over"
+	void alphaScalar(Colour255* destination, const Colour255* source, int num, Colour255)
+	{
+		for (int i = 0; i < num; i++)
+		{
+			const int alpha = source[i].alpha;
+			const int inverse = 255 - alpha;
+			Colour255& dest = destination[i];
+			dest.red = (BYTE)div255(source[i].red * alpha + dest.red * inverse);
+			dest.green = (BYTE)div255(source[i].green * alpha + dest.green * inverse);
+			dest.blue = (BYTE)div255(source[i].blue * alpha + dest.blue * inverse);
+			dest.alpha = (BYTE)div255(255 * alpha + dest.alpha * inverse);
+		}
+	}
+
+	void additiveScalar(Colour255* destination, const Colour255* source, int num, Colour255)
+	{
+		for (int i = 0; i < num; i++)
+		{
+			const int alpha = source[i].alpha;
+			Colour255& dest = destination[i];
+			dest.red = (BYTE)std::min(255, dest.red + div255(source[i].red * alpha));
+			dest.green = (BYTE)std::min(255, dest.green + div255(source[i].green * alpha));
+			dest.blue = (BYTE)std::min(255, dest.blue + div255(source[i].blue * alpha));
+		}
+	}
+
+	//The source is faded towards white by its alpha first, so transparent pixels multiply by one
+	void modulateScalar(Colour255* destination, const Colour255* source, int num, Colour255)
+	{
+		for (int i = 0; i < num; i++)
+		{
+			const int alpha = source[i].alpha;
+			Colour255& dest = destination[i];
+			dest.red = (BYTE)div255(dest.red * (255 - div255((255 - source[i].red) * alpha)));
+			dest.green = (BYTE)div255(dest.green * (255 - div255((255 - source[i].green) * alpha)));
+			dest.blue = (BYTE)div255(dest.blue * (255 - div255((255 - source[i].blue) * alpha)));
+		}
+	}
+
+	void tintScalar(Colour255* destination, const Colour255* source, int num, Colour255 tint)
+	{
+		for (int i = 0; i < num; i++)
+		{
+			const Colour255 tinted((BYTE)div255(source[i].red * tint.red), (BYTE)div255(source[i].green * tint.green),
+				(BYTE)div255(source[i].blue * tint.blue), (BYTE)div255(source[i].alpha * tint.alpha));
+			alphaScalar(&destination[i], &tinted, 1, tint);
+		}
+	}
+
+	//SSE2, 4 pixels a loop. Each half is widened to 16 bits per channel, two pixels of four channels.
+
+	inline __m128i div255(__m128i x)
+	{
+		x = _mm_add_epi16(x, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+
+	//Each pixel's alpha copied into all four of its channels
+	inline __m128i broadcastAlpha(__m128i pixels)
+	{
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	//Two widened pixels, the same maths as the scalar versions
+	inline __m128i alphaPair(__m128i dest, __m128i src, __m128i alpha)
+	{
+		const __m128i alphaChannel = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+		const __m128i inverse = _mm_xor_si128(alpha, _mm_set1_epi16(255));
+		src = _mm_or_si128(src, alphaChannel);
+		return div255(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dest, inverse)));
+	}
+
+	inline __m128i additivePair(__m128i src, __m128i alpha)
+	{
+		const __m128i colourChannels = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+		return _mm_and_si128(div255(_mm_mullo_epi16(src, alpha)), colourChannels);
+	}
+
+	inline __m128i modulatePair(__m128i dest, __m128i src, __m128i alpha)
+	{
+		const __m128i white = _mm_set1_epi16(255);
+		const __m128i alphaChannel = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+		//Alpha channel becomes 255 - 0 so the destination alpha is kept
+		const __m128i inverseSrc = _mm_andnot_si128(alphaChannel, _mm_sub_epi16(white, src));
+		const __m128i factor = _mm_sub_epi16(white, div255(_mm_mullo_epi16(inverseSrc, alpha)));
+		return div255(_mm_mullo_epi16(dest, factor));
+	}
+
+	template<typename PairFunction>
+	inline void blendSSE2(Colour255* destination, const Colour255* source, int num, PairFunction pair)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		int i = 0;
+		for (; i + 4 <= num; i += 4)
+		{
+			const __m128i dest = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+			const __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			const __m128i low = pair(_mm_unpacklo_epi8(dest, zero), _mm_unpacklo_epi8(src, zero));
+			const __m128i high = pair(_mm_unpackhi_epi8(dest, zero), _mm_unpackhi_epi8(src, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(low, high));
+		}
+	}
+
+	void alphaSSE2(Colour255* destination, const Colour255* source, int num, Colour255 tint)
+	{
+		blendSSE2(destination, source, num, [](__m128i dest, __m128i src) { return alphaPair(dest, src, broadcastAlpha(src)); });
+		alphaScalar(destination + (num & ~3), source + (num & ~3), num & 3, tint);
+	}
+
+	void additiveSSE2(Colour255* destination, const Colour255* source, int num, Colour255 tint)
+	{
+		//Added with saturation after packing, so it's done a whole register at a time
+		const __m128i zero = _mm_setzero_si128();
+		int i = 0;
+		for (; i + 4 <= num; i += 4)
+		{
+			const __m128i dest = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+			const __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			const __m128i srcLow = _mm_unpacklo_epi8(src, zero);
+			const __m128i srcHigh = _mm_unpackhi_epi8(src, zero);
+			const __m128i added = _mm_packus_epi16(additivePair(srcLow, broadcastAlpha(srcLow)), additivePair(srcHigh, broadcastAlpha(srcHigh)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_adds_epu8(dest, added));
+		}
+		additiveScalar(destination + i, source + i, num - i, tint);
+	}
+
+	void modulateSSE2(Colour255* destination, const Colour255* source, int num, Colour255 tint)
+	{
+		blendSSE2(destination, source, num, [](__m128i dest, __m128i src) { return modulatePair(dest, src, broadcastAlpha(src)); });
+		modulateScalar(destination + (num & ~3), source + (num & ~3), num & 3, tint);
+	}
+
+	void tintSSE2(Colour255* destination, const Colour255* source, int num, Colour255 tint)
+	{
+		const __m128i tintPair = _mm_set_epi16(tint.alpha, tint.blue, tint.green, tint.red, tint.alpha, tint.blue, tint.green, tint.red);
+		blendSSE2(destination, source, num, [&](__m128i dest, __m128i src)
+		{
+			const __m128i tinted = div255(_mm_mullo_epi16(src, tintPair));
+			return alphaPair(dest, tinted, broadcastAlpha(tinted));
+		});
+		tintScalar(destination + (num & ~3), source + (num & ~3), num & 3, tint);
+	}
+
+	//AVX2, 8 pixels a loop. Unpacking and packing both work within each 128 bit half, so they still undo each other.
+	//Kept apart from the SSE2 versions as only these functions may use AVX2 instructions.
+	//The upper halves are cleared before handing the rest to SSE2, older SSE code stalls on them otherwise.
+
+	AVX2_FUNCTION inline __m256i div255(__m256i x)
+	{
+		x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+		return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+	}
+
+	AVX2_FUNCTION inline __m256i broadcastAlpha(__m256i pixels)
+	{
+		return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	AVX2_FUNCTION inline __m256i alphaQuad(__m256i dest, __m256i src, __m256i alpha)
+	{
+		const __m256i alphaChannel = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+		const __m256i inverse = _mm256_xor_si256(alpha, _mm256_set1_epi16(255));
+		src = _mm256_or_si256(src, alphaChannel);
+		return div255(_mm256_add_epi16(_mm256_mullo_epi16(src, alpha), _mm256_mullo_epi16(dest, inverse)));
+	}
+
+	AVX2_FUNCTION void alphaAVX2(Colour255* destination, const Colour255* source, int num, Colour255 tint)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		int i = 0;
+		for (; i + 8 <= num; i += 8)
+		{
+			const __m256i dest = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination + i));
+			const __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+			const __m256i srcLow = _mm256_unpacklo_epi8(src, zero);
+			const __m256i srcHigh = _mm256_unpackhi_epi8(src, zero);
+			const __m256i low = alphaQuad(_mm256_unpacklo_epi8(dest, zero), srcLow, broadcastAlpha(srcLow));
+			const __m256i high = alphaQuad(_mm256_unpackhi_epi8(dest, zero), srcHigh, broadcastAlpha(srcHigh));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_packus_epi16(low, high));
+		}
+		_mm256_zeroupper();
+		alphaSSE2(destination + i, source + i, num - i, tint);
+	}
+
+	AVX2_FUNCTION void additiveAVX2(Colour255* destination, const Colour255* source, int num, Colour255 tint)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i colourChannels = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+		int i = 0;
+		for (; i + 8 <= num; i += 8)
+		{
+			const __m256i dest = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination + i));
+			const __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+			const __m256i srcLow = _mm256_unpacklo_epi8(src, zero);
+			const __m256i srcHigh = _mm256_unpackhi_epi8(src, zero);
+			const __m256i low = _mm256_and_si256(div255(_mm256_mullo_epi16(srcLow, broadcastAlpha(srcLow))), colourChannels);
+			const __m256i high = _mm256_and_si256(div255(_mm256_mullo_epi16(srcHigh, broadcastAlpha(srcHigh))), colourChannels);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_adds_epu8(dest, _mm256_packus_epi16(low, high)));
+		}
+		_mm256_zeroupper();
+		additiveSSE2(destination + i, source + i, num - i, tint);
+	}
+
+	AVX2_FUNCTION inline __m256i modulateQuad(__m256i dest, __m256i src)
+	{
+		const __m256i white = _mm256_set1_epi16(255);
+		const __m256i alphaChannel = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+		const __m256i inverseSrc = _mm256_andnot_si256(alphaChannel, _mm256_sub_epi16(white, src));
+		const __m256i factor = _mm256_sub_epi16(white, div255(_mm256_mullo_epi16(inverseSrc, broadcastAlpha(src))));
+		return div255(_mm256_mullo_epi16(dest, factor));
+	}
+
+	AVX2_FUNCTION void modulateAVX2(Colour255* destination, const Colour255* source, int num, Colour255 tint)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		int i = 0;
+		for (; i + 8 <= num; i += 8)
+		{
+			const __m256i dest = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination + i));
+			const __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+			const __m256i low = modulateQuad(_mm256_unpacklo_epi8(dest, zero), _mm256_unpacklo_epi8(src, zero));
+			const __m256i high = modulateQuad(_mm256_unpackhi_epi8(dest, zero), _mm256_unpackhi_epi8(src, zero));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_packus_epi16(low, high));
+		}
+		_mm256_zeroupper();
+		modulateSSE2(destination + i, source + i, num - i, tint);
+	}
+
+	AVX2_FUNCTION void tintAVX2(Colour255* destination, const Colour255* source, int num, Colour255 tint)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i tintQuad = _mm256_set_epi16(tint.alpha, tint.blue, tint.green, tint.red, tint.alpha, tint.blue, tint.green, tint.red,
+			tint.alpha, tint.blue, tint.green, tint.red, tint.alpha, tint.blue, tint.green, tint.red);
+		int i = 0;
+		for (; i + 8 <= num; i += 8)
+		{
+			const __m256i dest = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination + i));
+			const __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+			const __m256i tintedLow = div255(_mm256_mullo_epi16(_mm256_unpacklo_epi8(src, zero), tintQuad));
+			const __m256i tintedHigh = div255(_mm256_mullo_epi16(_mm256_unpackhi_epi8(src, zero), tintQuad));
+			const __m256i low = alphaQuad(_mm256_unpacklo_epi8(dest, zero), tintedLow, broadcastAlpha(tintedLow));
+			const __m256i high = alphaQuad(_mm256_unpackhi_epi8(dest, zero), tintedHigh, broadcastAlpha(tintedHigh));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_packus_epi16(low, high));
+		}
+		_mm256_zeroupper();
+		tintSSE2(destination + i, source + i, num - i, tint);
+	}
+
+	const SpanFunction SPAN_FUNCTIONS[3][4] =
+	{
+		{ alphaScalar, additiveScalar, modulateScalar, tintScalar },
+		{ alphaSSE2, additiveSSE2, modulateSSE2, tintSSE2 },
+		{ alphaAVX2, additiveAVX2, modulateAVX2, tintAVX2 }
+	};
+
+	eSimdLevel detectLevel()
+	{
+		//AVX2 also needs the OS to save the wide registers, which is what OSXSAVE and XGETBV report
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return eSimdSSE2;
+		__cpuid(info, 1);
+		const bool osSavesAVX = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		return osSavesAVX && (info[1] & (1 << 5)) ? eSimdAVX2 : eSimdSSE2;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") ? eSimdAVX2 : eSimdSSE2;
+#endif
+	}
+
+	SpanFunction getSpanFunction(eBlendKernel kernel, eSimdLevel level)
+	{
+		return SPAN_FUNCTIONS[std::min(level, BlendKernels::getSupportedLevel())][kernel];
+	}
+}
+
+eSimdLevel BlendKernels::getSupportedLevel()
+{
+	static const eSimdLevel level = detectLevel();
+	return level;
+}
+
+void BlendKernels::blendSpan(eBlendKernel kernel, Colour255* destination, const Colour255* source, int num, Colour255 tint, eSimdLevel level)
+{
+	getSpanFunction(kernel, level)(destination, source, num, tint);
+}
+
+void BlendKernels::blendSpan(eBlendKernel kernel, Colour255* destination, const Colour255* source, int num, Colour255 tint)
+{
+	blendSpan(kernel, destination, source, num, tint, getSupportedLevel());
+}
+
+BlendLambda BlendKernels::makeBlendLambda(eBlendKernel kernel, Colour255 tint)
+{
+	//Looked up once here rather than every scanline
+	const SpanFunction span = getSpanFunction(kernel, getSupportedLevel());
+	return [span, tint](const VectorI&, Colour255* destination, const Colour255* source, int num)
+	{
+		span(destination, source, num, tint);
+	};
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <functional>
+#include <HAPISprites_lib.h>
+
+//Signature Sprite::SetBlendLambda and Surface::Blit take, called once per scanline with num pixels from each
+typedef std::function<void(const HAPISPACE::VectorI& scanlineStart, HAPISPACE::Colour255* destination,
+	const HAPISPACE::Colour255* source, int num)> BlendLambda;
+
+enum eBlendKernel
+{
+	//Source drawn over the destination by its alpha
+	eBlendAlpha,
+	//Source times its alpha added to the destination, for glows and highlights
+	eBlendAdditive,
+	//Destination multiplied by the source, transparent source pixels leave it alone
+	eBlendModulate,
+	//Source multiplied by the tint colour then alpha blended, for faction colours
+	eBlendTint
+};
+
+enum eSimdLevel
+{
+	eSimdScalar,
+	eSimdSSE2,
+	eSimdAVX2
+};
+
+//Span blending for blend lambdas, 4 pixels at a time with SSE2 or 8 with AVX2.
+//Every level gives exactly the same result as the scalar one, so which is used only changes the speed.
+namespace BlendKernels
+{
+	//Best level this CPU supports, checked once
+	eSimdLevel getSupportedLevel();
+
+	//Blends num source pixels onto destination. Levels the CPU doesn't support fall back to the best one it does.
+	void blendSpan(eBlendKernel kernel, HAPISPACE::Colour255* destination, const HAPISPACE::Colour255* source, int num,
+		HAPISPACE::Colour255 tint, eSimdLevel level);
+	void blendSpan(eBlendKernel kernel, HAPISPACE::Colour255* destination, const HAPISPACE::Colour255* source, int num,
+		HAPISPACE::Colour255 tint = HAPISPACE::Colour255::WHITE);
+
+	//Sprites keep a pointer to their blend lambda, so keep the result alive for as long as a sprite uses it
+	//and set the sprite's blend mode to eUseLambda
+	BlendLambda makeBlendLambda(eBlendKernel kernel, HAPISPACE::Colour255 tint = HAPISPACE::Colour255::WHITE);
+}
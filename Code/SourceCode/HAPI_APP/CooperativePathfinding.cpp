@@ -0,0 +1,281 @@
+#include "CooperativePathfinding.h"
+#include "FlowField.h"
+#include "PathGrid.h"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+
+void ReservationTable::reserve(int tileIndex, int time)
+{
+	m_reserved.insert(getKey(tileIndex, time));
+	auto it = m_lastReserved.find(tileIndex);
+	if (it == m_lastReserved.end())
+		m_lastReserved[tileIndex] = time;
+	else
+		it->second = std::max(it->second, time);
+}
+
+void ReservationTable::park(int tileIndex, int fromTime)
+{
+	auto it = m_parkedFrom.find(tileIndex);
+	if (it == m_parkedFrom.end())
+		m_parkedFrom[tileIndex] = fromTime;
+	else
+		it->second = std::min(it->second, fromTime);
+}
+
+void ReservationTable::hold(int tileIndex, int fromTime)
+{
+	m_heldFrom[tileIndex] = fromTime;
+}
+
+void ReservationTable::release(int tileIndex)
+{
+	m_heldFrom.erase(tileIndex);
+}
+
+bool ReservationTable::isReserved(int tileIndex, int time) const
+{
+	auto parked = m_parkedFrom.find(tileIndex);
+	if (parked != m_parkedFrom.end() && parked->second <= time)
+		return true;
+	auto held = m_heldFrom.find(tileIndex);
+	if (held != m_heldFrom.end() && held->second <= time)
+		return true;
+	return m_reserved.find(getKey(tileIndex, time)) != m_reserved.end();
+}
+
+bool ReservationTable::isFreeFrom(int tileIndex, int time) const
+{
+	if (m_parkedFrom.find(tileIndex) != m_parkedFrom.end() || m_heldFrom.find(tileIndex) != m_heldFrom.end())
+		return false;
+	auto last = m_lastReserved.find(tileIndex);
+	return last == m_lastReserved.end() || last->second < time;
+}
+
+void ReservationTable::clear()
+{
+	m_reserved.clear();
+	m_parkedFrom.clear();
+	m_heldFrom.clear();
+	m_lastReserved.clear();
+}
+
+CooperativePathfinder::CooperativePathfinder(const PathGrid& grid, int window) :
+	m_grid(grid),
+	m_window(window > 0 ? window : 1),
+	m_reservations()
+{
+}
+
+bool CooperativePathfinder::searchWindow(int start, int goal, int startTime, const FlowField& field, std::vector<int>& tiles)
+{
+	//A state is a tile at a step into the window, packed as step * grid size + tile
+	struct Node
+	{
+		float m_g;
+		long long m_parent;
+	};
+	const long long size = m_grid.getSize();
+	const int endTime = startTime + m_window;
+	std::unordered_map<long long, Node> nodes;
+
+	auto getHeuristic = [this, &field](int tileIndex) { return field.getCost(m_grid.getCoordinate(tileIndex)); };
+
+	//open list contains pair <f, state>
+	typedef std::pair<float, long long> openEntry;
+	std::priority_queue<openEntry, std::vector<openEntry>, std::greater<openEntry>> openList;
+
+	//Waiting out the window where it is, unless someone else needs the tile meanwhile
+	auto holdPosition = [&]()
+	{
+		tiles.clear();
+		//The reservation at startTime is the ship's own, from the end of its last window
+		for (int time = startTime + 1; time <= endTime + 1; time++)
+		{
+			if (m_reservations.isReserved(start, time))
+				return;
+		}
+		tiles.assign(m_window + 1, start);
+	};
+
+	tiles.clear();
+	const float startH = getHeuristic(start);
+	if (startH == FLT_MAX)
+	{
+		//Can't get there at all
+		holdPosition();
+		return false;
+	}
+	nodes[start] = Node{ 0.0f, -1 };
+	openList.push(openEntry(startH, start));
+
+	long long found = -1;
+	bool arrived = false;
+	while (!openList.empty())
+	{
+		const openEntry p = openList.top();
+		openList.pop();
+
+		const Node& node = nodes[p.second];
+		const int tileIndex = static_cast<int>(p.second % size);
+		const int time = startTime + static_cast<int>(p.second / size);
+		if (p.first > node.m_g + getHeuristic(tileIndex))
+			continue;
+
+		if (tileIndex == goal && m_reservations.isFreeFrom(goal, time + 1))
+		{
+			found = p.second;
+			arrived = true;
+			break;
+		}
+		if (time == endTime)
+		{
+			found = p.second;
+			break;
+		}
+
+		const float g = node.m_g;
+		const long long nextStep = (p.second / size + 1) * size;
+		//Direction -1 is waiting where it is
+		for (int direction = -1; direction <= eNorthWest; direction++)
+		{
+			const int next = direction == -1 ? tileIndex : m_grid.getAdjacentIndex(tileIndex, direction);
+			if (next == -1 || !m_grid.isNavigable(next))
+				continue;
+			//The tile has to be free of other ships the step before and after as well,
+			//otherwise the moves of a step would depend on the order they are made in
+			if (m_reservations.isReserved(next, time + 1) || m_reservations.isReserved(next, time + 2))
+				continue;
+			if (direction != -1 && m_reservations.isReserved(next, time))
+				continue;
+
+			const float h = getHeuristic(next);
+			if (h == FLT_MAX)
+				continue;
+
+			const float sucG = g + (direction == -1 ? PathGrid::MIN_MOVEMENT_COST : m_grid.getMovementCost(next));
+			const long long state = nextStep + next;
+			auto it = nodes.find(state);
+			if (it == nodes.end() || sucG < it->second.m_g)
+			{
+				nodes[state] = Node{ sucG, p.second };
+				openList.push(openEntry(sucG + h, state));
+			}
+		}
+	}
+
+	if (found == -1)
+	{
+		//Boxed in by reservations
+		holdPosition();
+		return false;
+	}
+
+	for (long long state = found; state != -1; state = nodes[state].m_parent)
+		tiles.push_back(static_cast<int>(state % size));
+	std::reverse(tiles.begin(), tiles.end());
+	return arrived;
+}
+
+FleetPlan CooperativePathfinder::planFleet(const std::vector<FleetMove>& moves, int maxSteps)
+{
+	FleetPlan plan;
+	m_reservations.clear();
+	const int shipCount = static_cast<int>(moves.size());
+	plan.m_paths.resize(shipCount);
+	plan.m_arrived.assign(shipCount, false);
+	plan.m_unplannable.assign(shipCount, false);
+
+	std::vector<int> position(shipCount, -1);
+	std::vector<int> goal(shipCount, -1);
+	std::unordered_set<int> fleetTiles;
+	for (int ship = 0; ship < shipCount; ship++)
+	{
+		if (!m_grid.inBounds(moves[ship].m_start) || !m_grid.inBounds(moves[ship].m_goal) ||
+			fleetTiles.find(m_grid.getIndex(moves[ship].m_start)) != fleetTiles.end())
+		{
+			plan.m_unplannable[ship] = true;
+			continue;
+		}
+		position[ship] = m_grid.getIndex(moves[ship].m_start);
+		goal[ship] = m_grid.getIndex(moves[ship].m_goal);
+		fleetTiles.insert(position[ship]);
+		//Parked until the ship plans, ships before it mustn't route through where it is waiting
+		m_reservations.hold(position[ship], 0);
+		plan.m_paths[ship].push_back(moves[ship].m_start);
+	}
+
+	//Ships that aren't part of the move stay put throughout
+	for (int index = 0; index < m_grid.getSize(); index++)
+	{
+		if (m_grid.isOccupied(index) && fleetTiles.find(index) == fleetTiles.end())
+			m_reservations.park(index, 0);
+	}
+
+	//Ships heading for the same tile share one field
+	std::map<int, std::unique_ptr<FlowField>> fields;
+	for (int ship = 0; ship < shipCount; ship++)
+	{
+		if (goal[ship] != -1 && fields.find(goal[ship]) == fields.end())
+		{
+			const std::vector<std::pair<int, int>> goals(1, m_grid.getCoordinate(goal[ship]));
+			fields[goal[ship]] = std::unique_ptr<FlowField>(new FlowField(m_grid, goals));
+		}
+	}
+
+	std::vector<int> tiles;
+	int time = 0;
+	bool moving = true;
+	while (moving && time < maxSteps)
+	{
+		moving = false;
+		for (int ship = 0; ship < shipCount; ship++)
+		{
+			if (position[ship] == -1 || plan.m_arrived[ship] || plan.m_unplannable[ship])
+				continue;
+
+			m_reservations.release(position[ship]);
+			const bool arrived = searchWindow(position[ship], goal[ship], time, *fields[goal[ship]], tiles);
+			if (tiles.empty())
+			{
+				//Still in the way of everyone planning after it
+				m_reservations.hold(position[ship], time);
+				plan.m_unplannable[ship] = true;
+				continue;
+			}
+
+			//Step 0 too, the hold on it is gone and ships planning later can't enter a tile left the same step
+			for (size_t step = 0; step < tiles.size(); step++)
+				m_reservations.reserve(tiles[step], time + static_cast<int>(step));
+			if (arrived)
+			{
+				m_reservations.park(tiles.back(), time + static_cast<int>(tiles.size()) - 1);
+				plan.m_arrived[ship] = true;
+			}
+			else
+			{
+				m_reservations.hold(tiles.back(), time + static_cast<int>(tiles.size()) - 1);
+				moving = true;
+			}
+
+			for (size_t step = 1; step < tiles.size(); step++)
+				plan.m_paths[ship].push_back(m_grid.getCoordinate(tiles[step]));
+			position[ship] = tiles.back();
+		}
+		time += m_window;
+	}
+
+	//Pad so every ship has a tile for every step
+	size_t steps = 0;
+	for (const auto& path : plan.m_paths)
+		steps = std::max(steps, path.size());
+	for (int ship = 0; ship < shipCount; ship++)
+	{
+		if (!plan.m_unplannable[ship])
+			plan.m_paths[ship].resize(steps, plan.m_paths[ship].back());
+	}
+	return plan;
+}
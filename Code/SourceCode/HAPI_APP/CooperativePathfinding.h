@@ -0,0 +1,81 @@
+#pragma once
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class PathGrid;
+class FlowField;
+
+//Which tiles are taken at which time step, shared by every ship planning in the same pass
+class ReservationTable
+{
+private:
+	std::unordered_set<unsigned long long> m_reserved;
+	//Tiles held from a time step onwards, ships that have arrived and ships outside the fleet
+	std::unordered_map<int, int> m_parkedFrom;
+	//Like parked, but only until the ship on the tile plans its next moves
+	std::unordered_map<int, int> m_heldFrom;
+	//Latest time step each tile is reserved for, to tell if a ship can stop there for good
+	std::unordered_map<int, int> m_lastReserved;
+
+	static unsigned long long getKey(int tileIndex, int time) { return (static_cast<unsigned long long>(time) << 32) | static_cast<unsigned int>(tileIndex); }
+public:
+	void reserve(int tileIndex, int time);
+	void park(int tileIndex, int fromTime);
+	//A ship waiting for its turn to plan, it is in the way at every step until released
+	void hold(int tileIndex, int fromTime);
+	void release(int tileIndex);
+	bool isReserved(int tileIndex, int time) const;
+	//Nobody needs the tile at this time step or any later one
+	bool isFreeFrom(int tileIndex, int time) const;
+	void clear();
+};
+
+struct FleetMove
+{
+	std::pair<int, int> m_start;
+	std::pair<int, int> m_goal;
+};
+
+struct FleetPlan
+{
+	//m_paths[ship][step] is where the ship is after that many steps, step 0 is the start.
+	//Every path has the same length, ships that arrive early wait on their goal.
+	std::vector<std::vector<std::pair<int, int>>> m_paths;
+	std::vector<bool> m_arrived;
+	//Ships that had nowhere to be without running into another, their paths stop at the last step that was safe.
+	//Also set for ships starting off the grid or on the same tile as an earlier ship.
+	std::vector<bool> m_unplannable;
+
+	int getStepCount() const { return m_paths.empty() ? 0 : static_cast<int>(m_paths.front().size()); }
+};
+
+//Windowed cooperative A* (WHCA*) for moving a whole fleet at once.
+//Ships plan one after another through space and time, each reserving the tiles it will be on so the ones after
+//it route around them. Until a ship plans, its tile is held for every step, so no one plans through it.
+//Searches only look a window of steps ahead and carry on from there in later rounds,
+//beyond the window a flow field to the goal gives the remaining cost.
+//A ship never enters a tile someone holds on the step before or after, so the moves of any one step can be
+//applied with Map::moveEntity in any order.
+class CooperativePathfinder
+{
+private:
+	const PathGrid& m_grid;
+	int m_window;
+	ReservationTable m_reservations;
+
+	//Space-time A* from start at time startTime, tiles is filled with where the ship is on each step.
+	//Returns true if the ship reached its goal and can stay there. tiles is left empty if it can't even stay put.
+	bool searchWindow(int start, int goal, int startTime, const FlowField& field, std::vector<int>& tiles);
+public:
+	CooperativePathfinder(const PathGrid& grid, int window = 8);
+
+	//Earlier moves get first pick of the tiles. Ships that haven't arrived after maxSteps stop where they are.
+	//Paths are padded to the same length apart from those of unplannable ships.
+	//Any other occupied tile on the grid is treated as blocked for the whole plan.
+	FleetPlan planFleet(const std::vector<FleetMove>& moves, int maxSteps = 64);
+
+	void setWindow(int window) { m_window = window > 0 ? window : 1; }
+	int getWindow() const { return m_window; }
+};
@@ -0,0 +1,288 @@
+#include "DStarLite.h"
+#include <algorithm>
+
+DStarLite::Node::Node() :
+	m_g(FLT_MAX),
+	m_rhs(FLT_MAX),
+	m_open(false),
+	m_key(0.0f, 0.0f)
+{
+}
+
+DStarLite::DStarLite(const PathGrid& grid, std::pair<int, int> start, std::pair<int, int> goal, ePathPolicy policy) :
+	m_grid(grid),
+	m_policy(policy),
+	m_start(grid.getIndex(start)),
+	m_lastStart(grid.getIndex(start)),
+	m_goal(grid.getIndex(goal)),
+	m_keyModifier(0.0f),
+	m_nodes(),
+	m_openList(),
+	m_dirty(true),
+	m_expansions(0)
+{
+	Node& goalNode = m_nodes[m_goal];
+	goalNode.m_rhs = 0.0f;
+	goalNode.m_key = calculateKey(m_goal);
+	goalNode.m_open = true;
+	m_openList.insert(openEntry(goalNode.m_key, m_goal));
+}
+
+float DStarLite::getG(int index) const
+{
+	auto it = m_nodes.find(index);
+	return it == m_nodes.end() ? FLT_MAX : it->second.m_g;
+}
+
+float DStarLite::getRhs(int index) const
+{
+	auto it = m_nodes.find(index);
+	return it == m_nodes.end() ? FLT_MAX : it->second.m_rhs;
+}
+
+float DStarLite::getHeuristic(int from, int to) const
+{
+	return PathGrid::getDistance(m_grid.getCoordinate(from), m_grid.getCoordinate(to)) * PathGrid::MIN_MOVEMENT_COST;
+}
+
+float DStarLite::getEnterCost(int index) const
+{
+	if (!m_grid.canEnter(index, m_policy))
+		return FLT_MAX;
+	return m_grid.getMovementCost(index);
+}
+
+DStarLite::Key DStarLite::calculateKey(int index) const
+{
+	const float best = std::min(getG(index), getRhs(index));
+	if (best == FLT_MAX)
+		return Key(FLT_MAX, FLT_MAX);
+	return Key(best + getHeuristic(m_start, index) + m_keyModifier, best);
+}
+
+float DStarLite::calculateRhs(int index) const
+{
+	//Searching backwards, so the best way on from index towards the goal
+	float best = FLT_MAX;
+	for (int direction = eNorth; direction <= eNorthWest; direction++)
+	{
+		const int adjacent = m_grid.getAdjacentIndex(index, direction);
+		if (adjacent == -1)
+			continue;
+		const float g = getG(adjacent);
+		const float cost = getEnterCost(adjacent);
+		if (g == FLT_MAX || cost == FLT_MAX)
+			continue;
+		best = std::min(best, g + cost);
+	}
+	return best;
+}
+
+void DStarLite::updateVertex(int index)
+{
+	Node& node = m_nodes[index];
+	if (index != m_goal)
+		node.m_rhs = calculateRhs(index);
+
+	if (node.m_open)
+	{
+		m_openList.erase(openEntry(node.m_key, index));
+		node.m_open = false;
+	}
+	if (node.m_g != node.m_rhs)
+	{
+		node.m_key = calculateKey(index);
+		node.m_open = true;
+		m_openList.insert(openEntry(node.m_key, index));
+	}
+}
+
+void DStarLite::setStart(std::pair<int, int> start)
+{
+	const int index = m_grid.getIndex(start);
+	if (index == m_start)
+		return;
+
+	m_start = index;
+	m_keyModifier += getHeuristic(m_lastStart, m_start);
+	m_lastStart = m_start;
+	m_dirty = true;
+}
+
+void DStarLite::onTileChanged(std::pair<int, int> coord, eTileChange change)
+{
+	if (change == eOccupancyChange && m_policy == eIgnoreShips)
+		return;
+
+	//Entering the tile is what changed, so only the tiles that step onto it need their rhs redone
+	const int index = m_grid.getIndex(coord);
+	for (int direction = eNorth; direction <= eNorthWest; direction++)
+	{
+		const int adjacent = m_grid.getAdjacentIndex(index, direction);
+		if (adjacent != -1 && m_nodes.find(adjacent) != m_nodes.end())
+		{
+			updateVertex(adjacent);
+			m_dirty = true;
+		}
+	}
+}
+
+void DStarLite::computeShortestPath()
+{
+	if (!m_dirty)
+		return;
+
+	while (!m_openList.empty() &&
+		(m_openList.begin()->first < calculateKey(m_start) || getRhs(m_start) != getG(m_start)))
+	{
+		const openEntry top = *m_openList.begin();
+		const int index = top.second;
+		const Key newKey = calculateKey(index);
+		Node& node = m_nodes[index];
+		m_expansions++;
+
+		if (top.first < newKey)
+		{
+			m_openList.erase(m_openList.begin());
+			node.m_key = newKey;
+			m_openList.insert(openEntry(newKey, index));
+			continue;
+		}
+
+		m_openList.erase(m_openList.begin());
+		node.m_open = false;
+		if (node.m_g > node.m_rhs)
+		{
+			node.m_g = node.m_rhs;
+		}
+		else
+		{
+			node.m_g = FLT_MAX;
+			updateVertex(index);
+		}
+
+		for (int direction = eNorth; direction <= eNorthWest; direction++)
+		{
+			const int adjacent = m_grid.getAdjacentIndex(index, direction);
+			if (adjacent != -1)
+				updateVertex(adjacent);
+		}
+	}
+	m_dirty = false;
+}
+
+bool DStarLite::hasRoute() const
+{
+	return getG(m_start) != FLT_MAX || m_start == m_goal;
+}
+
+std::pair<int, int> DStarLite::getNextTile() const
+{
+	int best = m_start;
+	float bestCost = FLT_MAX;
+	if (m_start == m_goal)
+		return m_grid.getCoordinate(m_start);
+
+	for (int direction = eNorth; direction <= eNorthWest; direction++)
+	{
+		const int adjacent = m_grid.getAdjacentIndex(m_start, direction);
+		if (adjacent == -1)
+			continue;
+		const float g = getG(adjacent);
+		const float cost = getEnterCost(adjacent);
+		if (g == FLT_MAX || cost == FLT_MAX)
+			continue;
+		if (g + cost < bestCost)
+		{
+			bestCost = g + cost;
+			best = adjacent;
+		}
+	}
+	return m_grid.getCoordinate(best);
+}
+
+std::vector<std::pair<int, int>> DStarLite::getPath() const
+{
+	std::vector<std::pair<int, int>> path;
+	if (!hasRoute())
+		return path;
+
+	int current = m_start;
+	path.push_back(m_grid.getCoordinate(current));
+	while (current != m_goal)
+	{
+		int next = -1;
+		float bestCost = FLT_MAX;
+		for (int direction = eNorth; direction <= eNorthWest; direction++)
+		{
+			const int adjacent = m_grid.getAdjacentIndex(current, direction);
+			if (adjacent == -1)
+				continue;
+			const float g = getG(adjacent);
+			const float cost = getEnterCost(adjacent);
+			if (g == FLT_MAX || cost == FLT_MAX)
+				continue;
+			if (g + cost < bestCost)
+			{
+				bestCost = g + cost;
+				next = adjacent;
+			}
+		}
+		//Shouldn't happen once computeShortestPath is up to date, but never loop forever on a stale search
+		if (next == -1 || path.size() > static_cast<size_t>(m_grid.getSize()))
+			return std::vector<std::pair<int, int>>();
+		current = next;
+		path.push_back(m_grid.getCoordinate(current));
+	}
+	return path;
+}
+
+FleetRoutePlanner::FleetRoutePlanner(const PathGrid& grid) :
+	m_grid(grid),
+	m_routes(),
+	m_nextRouteId(0)
+{
+}
+
+int FleetRoutePlanner::addRoute(std::pair<int, int> start, std::pair<int, int> goal, ePathPolicy policy)
+{
+	if (!m_grid.inBounds(start) || !m_grid.inBounds(goal))
+		return -1;
+
+	const int routeId = m_nextRouteId++;
+	m_routes[routeId] = std::unique_ptr<DStarLite>(new DStarLite(m_grid, start, goal, policy));
+	return routeId;
+}
+
+void FleetRoutePlanner::removeRoute(int routeId)
+{
+	m_routes.erase(routeId);
+}
+
+void FleetRoutePlanner::setStart(int routeId, std::pair<int, int> start)
+{
+	auto it = m_routes.find(routeId);
+	if (it != m_routes.end() && m_grid.inBounds(start))
+		it->second->setStart(start);
+}
+
+void FleetRoutePlanner::onTileChanged(std::pair<int, int> coord, eTileChange change)
+{
+	for (auto& route : m_routes)
+		route.second->onTileChanged(coord, change);
+}
+
+void FleetRoutePlanner::replan()
+{
+	for (auto& route : m_routes)
+	{
+		if (route.second->isDirty())
+			route.second->computeShortestPath();
+	}
+}
+
+const DStarLite* FleetRoutePlanner::getRoute(int routeId) const
+{
+	auto it = m_routes.find(routeId);
+	return it == m_routes.end() ? nullptr : it->second.get();
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <float.h>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "MapListener.h"
+#include "PathGrid.h"
+
+//D* Lite route from a moving ship to a fixed goal.
+//The search runs backwards from the goal and its state is kept between turns, so when tiles change only
+//the part of the search they affect is repaired instead of planning the whole route again.
+class DStarLite
+{
+private:
+	//Priority of a tile in the open list, compared first then second
+	typedef std::pair<float, float> Key;
+	typedef std::pair<Key, int> openEntry;
+
+	struct Node
+	{
+		float m_g;
+		float m_rhs;
+		bool m_open;
+		Key m_key;
+
+		Node();
+	};
+
+	const PathGrid& m_grid;
+	ePathPolicy m_policy;
+	int m_start;
+	int m_lastStart;
+	int m_goal;
+	//Grows as the ship moves so old keys in the open list stay valid
+	float m_keyModifier;
+	std::unordered_map<int, Node> m_nodes;
+	std::set<openEntry> m_openList;
+	bool m_dirty;
+	unsigned int m_expansions;
+
+	float getG(int index) const;
+	float getRhs(int index) const;
+	float getHeuristic(int from, int to) const;
+	//Cost of stepping onto index, FLT_MAX if it can't be entered
+	float getEnterCost(int index) const;
+	Key calculateKey(int index) const;
+	void updateVertex(int index);
+	float calculateRhs(int index) const;
+public:
+	DStarLite(const PathGrid& grid, std::pair<int, int> start, std::pair<int, int> goal, ePathPolicy policy = eAvoidShips);
+
+	//Call when the ship moves, the search is kept rather than restarted
+	void setStart(std::pair<int, int> start);
+	//Call when a tile changes occupancy or terrain. Cheap if the search never got near it.
+	void onTileChanged(std::pair<int, int> coord, eTileChange change);
+	//Repairs the search after any changes, does nothing if there were none
+	void computeShortestPath();
+
+	bool isDirty() const { return m_dirty; }
+	bool hasRoute() const;
+	std::pair<int, int> getStart() const { return m_grid.getCoordinate(m_start); }
+	std::pair<int, int> getGoal() const { return m_grid.getCoordinate(m_goal); }
+	//Tile to move onto next, the start itself if at the goal or there is no route
+	std::pair<int, int> getNextTile() const;
+	//Route from start to goal inclusive, empty if there is none
+	std::vector<std::pair<int, int>> getPath() const;
+	//Tiles expanded since the planner was created, to see what replanning costs
+	unsigned int getExpansions() const { return m_expansions; }
+};
+
+//Keeps a D* Lite planner per ship and forwards map changes to them.
+//Planners are only repaired in replan and only if a change reached them, so a turn's replanning cost
+//follows the amount the map changed rather than the number of routes.
+class FleetRoutePlanner : public IMapListener
+{
+private:
+	const PathGrid& m_grid;
+	std::unordered_map<int, std::unique_ptr<DStarLite>> m_routes;
+	int m_nextRouteId;
+public:
+	FleetRoutePlanner(const PathGrid& grid);
+
+	//Returns an id used to refer to the route from then on
+	int addRoute(std::pair<int, int> start, std::pair<int, int> goal, ePathPolicy policy = eAvoidShips);
+	void removeRoute(int routeId);
+	void setStart(int routeId, std::pair<int, int> start);
+	void onTileChanged(std::pair<int, int> coord, eTileChange change) override;
+	//Repairs every route touched by changes since the last call
+	void replan();
+
+	//Returns nullptr for an unknown id
+	const DStarLite* getRoute(int routeId) const;
+	size_t getRouteCount() const { return m_routes.size(); }
+};
@@ -0,0 +1,180 @@
+#include "DirtyRegionTracker.h"
+#include <algorithm>
+#include <math.h>
+
+using namespace HAPISPACE;
+
+namespace
+{
+	bool touches(const RectangleI& a, const RectangleI& b)
+	{
+		return a.left <= b.right && b.left <= a.right && a.top <= b.bottom && b.top <= a.bottom;
+	}
+
+	bool sameArea(const RectangleI& a, const RectangleI& b)
+	{
+		return a.left == b.left && a.right == b.right && a.top == b.top && a.bottom == b.bottom;
+	}
+}
+
+const RectangleI DirtyRegionTracker::FPS_COUNTER_AREA(0, 160, 0, 40);
+
+DirtyRegionTracker::DirtyRegionTracker(RectangleI screen) :
+	m_screen(screen),
+	m_regions(),
+	m_overlays(),
+	m_sprites(),
+	m_texts(),
+	m_allDirty(true)
+{
+}
+
+void DirtyRegionTracker::markDirty(RectangleI area)
+{
+	area.ClipTo(m_screen);
+	if (!m_allDirty && area.IsValid())
+		m_regions.push_back(area);
+}
+
+void DirtyRegionTracker::markAllDirty()
+{
+	m_allDirty = true;
+	m_regions.clear();
+}
+
+void DirtyRegionTracker::trackSprite(const Sprite& sprite, bool visible)
+{
+	RectangleI area;
+	if (visible)
+	{
+		//Rounded outwards since sprites can sit at fractions of a pixel
+		const VectorF& position = sprite.GetTransformComp().GetPosition();
+		const VectorF& scale = sprite.GetTransformComp().GetScale();
+		area = RectangleI(
+			(int)floor(position.x) - 1, (int)ceil(position.x + sprite.FrameWidth() * scale.x) + 1,
+			(int)floor(position.y) - 1, (int)ceil(position.y + sprite.FrameHeight() * scale.y) + 1);
+	}
+
+	auto it = m_sprites.find(&sprite);
+	if (it == m_sprites.end())
+	{
+		markDirty(area);
+		m_sprites[&sprite] = TrackedSprite{ area, sprite.GetFrameNumber() };
+		return;
+	}
+	if (sameArea(it->second.m_area, area) && it->second.m_frame == sprite.GetFrameNumber())
+		return;
+
+	markDirty(it->second.m_area);
+	markDirty(area);
+	it->second = TrackedSprite{ area, sprite.GetFrameNumber() };
+}
+
+void DirtyRegionTracker::forgetSprite(const Sprite& sprite)
+{
+	auto it = m_sprites.find(&sprite);
+	if (it == m_sprites.end())
+		return;
+	markDirty(it->second.m_area);
+	m_sprites.erase(it);
+}
+
+void DirtyRegionTracker::trackText(int id, RectangleI area, const std::string& text)
+{
+	auto it = m_texts.find(id);
+	if (it != m_texts.end() && sameArea(it->second.m_area, area) && it->second.m_text == text)
+		return;
+
+	if (it != m_texts.end())
+		markDirty(it->second.m_area);
+	markDirty(area);
+	m_texts[id] = TrackedText{ area, text };
+}
+
+void DirtyRegionTracker::addOverlay(RectangleI area)
+{
+	area.ClipTo(m_screen);
+	if (area.IsValid())
+		m_overlays.push_back(area);
+}
+
+void DirtyRegionTracker::removeOverlay(RectangleI area)
+{
+	area.ClipTo(m_screen);
+	auto it = std::find_if(m_overlays.begin(), m_overlays.end(), [&](const RectangleI& overlay) { return sameArea(overlay, area); });
+	if (it != m_overlays.end())
+	{
+		m_overlays.erase(it);
+		//Whatever the overlay drew over is left on screen until drawn over
+		markDirty(area);
+	}
+}
+
+void DirtyRegionTracker::mergeRegions()
+{
+	//Joins touching regions until none touch
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (size_t i = 0; i < m_regions.size() && !merged; i++)
+		{
+			for (size_t j = i + 1; j < m_regions.size(); j++)
+			{
+				if (touches(m_regions[i], m_regions[j]))
+				{
+					m_regions[i].Encompass(m_regions[j]);
+					m_regions.erase(m_regions.begin() + j);
+					merged = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (m_regions.size() > MAX_REGIONS)
+	{
+		RectangleI bounds = m_regions[0];
+		for (const RectangleI& region : m_regions)
+			bounds.Encompass(region);
+		m_regions.assign(1, bounds);
+	}
+}
+
+DirtyRegionTracker::Regions DirtyRegionTracker::takeRegions()
+{
+	Regions regions{ m_allDirty, std::vector<RectangleI>() };
+	if (m_allDirty)
+	{
+		regions.m_areas.push_back(m_screen);
+	}
+	else
+	{
+		m_regions.insert(m_regions.end(), m_overlays.begin(), m_overlays.end());
+		mergeRegions();
+		regions.m_areas.swap(m_regions);
+	}
+
+	m_regions.clear();
+	m_allDirty = false;
+	return regions;
+}
+
+void DirtyRegionTracker::redraw(const std::shared_ptr<Surface>& screen, const Regions& regions, const std::function<void(const RectangleI& area)>& draw)
+{
+	if (regions.m_all)
+	{
+		screen->Clear();
+		draw(regions.m_areas[0]);
+		return;
+	}
+
+	for (const RectangleI& region : regions.m_areas)
+	{
+		const RectangleI oldClipArea = screen->SetClipArea(region);
+		screen->DrawFilledRect(RectangleF((float)region.left, (float)region.right, (float)region.top, (float)region.bottom),
+			ColourFill(Colour255::BLACK));
+		draw(region);
+		screen->SetClipArea(oldClipArea);
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <HAPISprites_lib.h>
+
+//Areas of the screen that changed since the last frame, so only those are cleared and drawn again.
+//Anything outside them is left on the screen from the frame before, so a frame where nothing changed draws nothing.
+class DirtyRegionTracker
+{
+private:
+	struct TrackedSprite
+	{
+		HAPISPACE::RectangleI m_area;
+		int m_frame;
+	};
+	struct TrackedText
+	{
+		HAPISPACE::RectangleI m_area;
+		std::string m_text;
+	};
+
+	//Past this many separate regions they are joined into one, drawing the scene again per region stops paying off
+	static constexpr size_t MAX_REGIONS = 8;
+
+	HAPISPACE::RectangleI m_screen;
+	std::vector<HAPISPACE::RectangleI> m_regions;
+	std::vector<HAPISPACE::RectangleI> m_overlays;
+	std::unordered_map<const HAPISPACE::Sprite*, TrackedSprite> m_sprites;
+	std::unordered_map<int, TrackedText> m_texts;
+	bool m_allDirty;
+
+	void mergeRegions();
+public:
+	//A frame's regions to redraw, taken from the tracker so they can be drawn while the next frame is tracked
+	struct Regions
+	{
+		bool m_all;
+		std::vector<HAPISPACE::RectangleI> m_areas;
+	};
+
+	//Where HAPI draws its FPS counter each frame, add it as an overlay while the counter is shown
+	static const HAPISPACE::RectangleI FPS_COUNTER_AREA;
+
+	DirtyRegionTracker(HAPISPACE::RectangleI screen);
+
+	void markDirty(HAPISPACE::RectangleI area);
+	void markAllDirty();
+	//Marks where the sprite is now and where it was when last tracked, if it has moved, resized or changed frame.
+	//Call once a frame for each sprite that can change, after updating it. Sprites tracked as hidden are drawn nowhere.
+	void trackSprite(const HAPISPACE::Sprite& sprite, bool visible = true);
+	void forgetSprite(const HAPISPACE::Sprite& sprite);
+	//Marks the text's area if it changed since last tracked under the same id
+	void trackText(int id, HAPISPACE::RectangleI area, const std::string& text);
+	//Areas drawn over every frame by something else, like HAPI's UI windows, are redrawn underneath every frame
+	void addOverlay(HAPISPACE::RectangleI area);
+	void removeOverlay(HAPISPACE::RectangleI area);
+
+	bool isClean() const { return !m_allDirty && m_regions.empty() && m_overlays.empty(); }
+	//Merged regions for this frame, including overlays, then starts the next frame clean
+	Regions takeRegions();
+	//Clears each region and calls draw with drawing clipped to it and the region
+	static void redraw(const std::shared_ptr<HAPISPACE::Surface>& screen, const Regions& regions,
+		const std::function<void(const HAPISPACE::RectangleI& area)>& draw);
+	void redraw(const std::shared_ptr<HAPISPACE::Surface>& screen, const std::function<void(const HAPISPACE::RectangleI& area)>& draw)
+	{
+		redraw(screen, takeRegions(), draw);
+	}
+};
@@ -0,0 +1,70 @@
+#include "DrawList.h"
+#include <algorithm>
+#include <climits>
+#include <math.h>
+
+using namespace HAPISPACE;
+
+RectangleI DrawCommand::getBounds() const
+{
+	if (m_transform.IsRotated())
+		return RectangleI(INT_MIN / 2, INT_MAX / 2, INT_MIN / 2, INT_MAX / 2);
+
+	const float left = m_transform.position.x - m_transform.origin.x * m_transform.scale.x;
+	const float top = m_transform.position.y - m_transform.origin.y * m_transform.scale.y;
+	return RectangleI(
+		(int)floor(left) - 1, (int)ceil(left + m_area.Width() * m_transform.scale.x) + 1,
+		(int)floor(top) - 1, (int)ceil(top + m_area.Height() * m_transform.scale.y) + 1);
+}
+
+DrawList::DrawList() :
+	m_commands(),
+	m_sorted(true)
+{
+}
+
+void DrawList::add(eDrawLayer layer, float depth, std::shared_ptr<Surface> surface, RectangleI area, const Transform& transform)
+{
+	m_commands.push_back(DrawCommand{ layer, depth, surface, area, transform, static_cast<unsigned int>(m_commands.size()) });
+	m_sorted = false;
+}
+
+void DrawList::add(eDrawLayer layer, float depth, const Sprite& sprite)
+{
+	add(layer, depth, sprite.GetSurface(), sprite.GetCurrentFrameRect(), sprite.GetTransformComp().GetTransform());
+}
+
+void DrawList::sort()
+{
+	if (m_sorted)
+		return;
+
+	std::sort(m_commands.begin(), m_commands.end(), [](const DrawCommand& a, const DrawCommand& b)
+	{
+		if (a.m_layer != b.m_layer)
+			return a.m_layer < b.m_layer;
+		if (a.m_depth != b.m_depth)
+			return a.m_depth < b.m_depth;
+		if (a.m_surface != b.m_surface)
+			return a.m_surface < b.m_surface;
+		if (a.m_area.top != b.m_area.top)
+			return a.m_area.top < b.m_area.top;
+		if (a.m_area.left != b.m_area.left)
+			return a.m_area.left < b.m_area.left;
+		return a.m_order < b.m_order;
+	});
+	m_sorted = true;
+}
+
+void DrawList::render(const std::shared_ptr<Surface>& target)
+{
+	sort();
+	for (const DrawCommand& command : m_commands)
+		target->Blit(command.m_surface, command.m_transform, command.m_area);
+}
+
+void DrawList::clear()
+{
+	m_commands.clear();
+	m_sorted = true;
+}
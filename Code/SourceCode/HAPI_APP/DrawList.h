@@ -0,0 +1,52 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <HAPISprites_lib.h>
+
+//Layers are drawn in this order, whatever order things were added in
+enum eDrawLayer
+{
+	eLayerTerrain,
+	eLayerShips,
+	eLayerUI
+};
+
+struct DrawCommand
+{
+	eDrawLayer m_layer;
+	//Within a layer lower depths are drawn first, for ships this is how far down the screen they are
+	float m_depth;
+	std::shared_ptr<HAPISPACE::Surface> m_surface;
+	//Area of the surface to draw, the frame for sprites
+	HAPISPACE::RectangleI m_area;
+	HAPISPACE::Transform m_transform;
+	//Order added, so commands that tie on everything else keep it
+	unsigned int m_order;
+
+	//Screen area it can draw to, rounded out a pixel. Rotated commands are treated as drawing anywhere.
+	HAPISPACE::RectangleI getBounds() const;
+};
+
+//Everything drawn in a frame. Game code adds to it instead of rendering sprites itself, then it is sorted once
+//and can be drawn as many times as needed, once per dirty region say.
+//Sorted by layer, then depth, then the surface drawn from and the frame, so draws reading the same texture run together.
+class DrawList
+{
+private:
+	std::vector<DrawCommand> m_commands;
+	bool m_sorted;
+public:
+	DrawList();
+
+	void add(eDrawLayer layer, float depth, std::shared_ptr<HAPISPACE::Surface> surface,
+		HAPISPACE::RectangleI area, const HAPISPACE::Transform& transform);
+	//The sprite's current frame where it is now, its blend mode isn't kept so it must use normal alpha blending
+	void add(eDrawLayer layer, float depth, const HAPISPACE::Sprite& sprite);
+	void sort();
+	//Sorts first if anything was added since the last sort
+	void render(const std::shared_ptr<HAPISPACE::Surface>& target);
+	void clear();
+
+	size_t size() const { return m_commands.size(); }
+	const std::vector<DrawCommand>& getCommands() const { return m_commands; }
+};
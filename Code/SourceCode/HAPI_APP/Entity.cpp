@@ -1,6 +1,20 @@
 #include "Entity.h"
 
-Entity::Entity(std::string filename)
+//Movement points a ship starts with until it is given its own
+constexpr float DEFAULT_MOVEMENT_POINTS = 6.0f;
+
+Entity::Entity(std::string filename) :
+	m_sprite(nullptr),
+	m_alive(true),
+	m_selected(false),
+	m_maxHealth(0),
+	m_health(0),
+	m_maxMovementPoints(DEFAULT_MOVEMENT_POINTS),
+	m_movementPoints(DEFAULT_MOVEMENT_POINTS),
+	m_direction(eNorth),
+	m_tileLocation(0, 0),
+	m_faction(faction::eFaction1),
+	m_weapons()
 {
 	m_sprite = HAPI_Sprites.LoadSprite(filename);
 }
@@ -67,6 +81,11 @@ float Entity::getMovementPoints() const
 	return m_movementPoints;
 }
 
+float Entity::getMaxMovementPoints() const
+{
+	return m_maxMovementPoints;
+}
+
 void Entity::setDirection(eDirection newDirection)
 {
 	m_direction = newDirection;
@@ -0,0 +1,181 @@
+#include "FacingPathfinding.h"
+#include <algorithm>
+#include <cmath>
+
+FacingPathfinder::FacingPathfinder() :
+	m_turnInPlaceCost(toUnits(1.0f)),
+	m_searchStamp(0),
+	m_expansions(0),
+	m_lastCost(BLOCKED)
+{
+	//Gentle turns are cheap, ships can't sail back the way they are facing
+	m_turnPenalty[0] = 0;
+	m_turnPenalty[1] = toUnits(0.5f);
+	m_turnPenalty[2] = toUnits(1.0f);
+	m_turnPenalty[3] = BLOCKED;
+}
+
+int FacingPathfinder::toUnits(float cost)
+{
+	if (cost == FLT_MAX)
+		return BLOCKED;
+	return std::max(0, static_cast<int>(std::lround(cost * COST_SCALE)));
+}
+
+int FacingPathfinder::getTurnSteps(int from, int to)
+{
+	const int difference = std::abs(from - to);
+	return std::min(difference, 6 - difference);
+}
+
+void FacingPathfinder::setTurnPenalty(int turnSteps, float cost)
+{
+	if (turnSteps >= 1 && turnSteps <= 3)
+		m_turnPenalty[turnSteps] = toUnits(cost);
+}
+
+float FacingPathfinder::getTurnPenalty(int turnSteps) const
+{
+	if (turnSteps < 0 || turnSteps > 3 || m_turnPenalty[turnSteps] == BLOCKED)
+		return FLT_MAX;
+	return static_cast<float>(m_turnPenalty[turnSteps]) / COST_SCALE;
+}
+
+void FacingPathfinder::setTurnInPlaceCost(float cost)
+{
+	m_turnInPlaceCost = toUnits(cost);
+}
+
+float FacingPathfinder::getLastCost() const
+{
+	if (m_lastCost == BLOCKED)
+		return FLT_MAX;
+	return static_cast<float>(m_lastCost) / COST_SCALE;
+}
+
+void FacingPathfinder::prepareWorkspace(int stateCount)
+{
+	if (static_cast<int>(m_searchStamps.size()) != stateCount)
+	{
+		m_searchCost.assign(stateCount, INT_MAX);
+		m_searchParent.assign(stateCount, -1);
+		m_searchStamps.assign(stateCount, 0);
+		m_searchStamp = 0;
+	}
+
+	m_searchStamp++;
+	if (m_searchStamp == 0)
+	{
+		//Wrapped around, old stamps could match again
+		std::fill(m_searchStamps.begin(), m_searchStamps.end(), 0);
+		m_searchStamp = 1;
+	}
+}
+
+void FacingPathfinder::push(int f, int state)
+{
+	if (static_cast<int>(m_buckets.size()) <= f)
+		m_buckets.resize(f + 1);
+	m_buckets[f].push_back(state);
+}
+
+std::vector<FacingState> FacingPathfinder::findPath(const PathGrid& grid, std::pair<int, int> src, eDirection srcFacing,
+	std::pair<int, int> dest, int destFacing, ePathPolicy policy)
+{
+	std::vector<FacingState> path;
+	m_expansions = 0;
+	m_lastCost = BLOCKED;
+	if (!grid.inBounds(src) || !grid.inBounds(dest) || destFacing < -1 || destFacing > eNorthWest)
+		return path;
+
+	const int destIndex = grid.getIndex(dest);
+	if (!grid.canEnter(destIndex, policy))
+		return path;
+
+	prepareWorkspace(grid.getSize() * 6);
+	auto getHeuristic = [&grid, dest](int tileIndex) { return PathGrid::getDistance(grid.getCoordinate(tileIndex), dest) * toUnits(PathGrid::MIN_MOVEMENT_COST); };
+
+	const int startState = grid.getIndex(src) * 6 + srcFacing;
+	m_searchCost[startState] = 0;
+	m_searchParent[startState] = startState;
+	m_searchStamps[startState] = m_searchStamp;
+	const int startF = getHeuristic(grid.getIndex(src));
+	push(startF, startState);
+
+	int found = -1;
+	int current = startF;
+	//A consistent heuristic means f never drops, so the buckets are only ever walked forwards
+	for (; current < static_cast<int>(m_buckets.size()) && found == -1; current++)
+	{
+		//Pushing can grow m_buckets, so no reference to the bucket is held across it
+		while (!m_buckets[current].empty())
+		{
+			const int state = m_buckets[current].back();
+			m_buckets[current].pop_back();
+
+			const int tileIndex = state / 6;
+			const int facing = state % 6;
+			const int g = m_searchCost[state];
+			if (g + getHeuristic(tileIndex) != current)
+				continue;
+			m_expansions++;
+			if (tileIndex == destIndex && (destFacing == -1 || facing == destFacing))
+			{
+				found = state;
+				break;
+			}
+
+			for (int direction = eNorth; direction <= eNorthWest; direction++)
+			{
+				const int penalty = m_turnPenalty[getTurnSteps(facing, direction)];
+				if (penalty == BLOCKED)
+					continue;
+				const int adjacent = grid.getAdjacentIndex(tileIndex, direction);
+				if (adjacent == -1 || !grid.canEnter(adjacent, policy))
+					continue;
+
+				const int next = adjacent * 6 + direction;
+				const int sucG = g + toUnits(grid.getMovementCost(adjacent)) + penalty;
+				if (sucG < getSearchCost(next))
+				{
+					m_searchCost[next] = sucG;
+					m_searchParent[next] = state;
+					m_searchStamps[next] = m_searchStamp;
+					push(sucG + getHeuristic(adjacent), next);
+				}
+			}
+
+			if (m_turnInPlaceCost == BLOCKED)
+				continue;
+			for (int turn = 1; turn <= 5; turn += 4)
+			{
+				const int next = tileIndex * 6 + (facing + turn) % 6;
+				const int sucG = g + m_turnInPlaceCost;
+				if (sucG < getSearchCost(next))
+				{
+					m_searchCost[next] = sucG;
+					m_searchParent[next] = state;
+					m_searchStamps[next] = m_searchStamp;
+					push(sucG + getHeuristic(tileIndex), next);
+				}
+			}
+		}
+	}
+
+	//Leave the buckets empty for the next search, they keep their capacity
+	for (int f = startF; f < static_cast<int>(m_buckets.size()); f++)
+		m_buckets[f].clear();
+
+	if (found == -1)
+		return path;
+
+	m_lastCost = m_searchCost[found];
+	for (int state = found; ; state = m_searchParent[state])
+	{
+		path.push_back(FacingState{ grid.getCoordinate(state / 6), static_cast<eDirection>(state % 6) });
+		if (state == startState)
+			break;
+	}
+	std::reverse(path.begin(), path.end());
+	return path;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <float.h>
+#include <limits.h>
+#include <utility>
+#include <vector>
+#include "PathGrid.h"
+
+//A tile and the way the ship on it is pointing
+struct FacingState
+{
+	std::pair<int, int> m_tile;
+	eDirection m_facing;
+};
+
+//A* over (tile, facing) states, so a ship pays for turning as well as for distance.
+//Moving always happens in the direction of the step taken, turning in place costs a turn at a time.
+//States are packed as tile * 6 + facing and costs are kept in whole units so the open list can be a bucket queue,
+//which keeps the search about as quick as the tile-only one despite having six times the states.
+class FacingPathfinder
+{
+private:
+	//Costs are stored as integers in 1/COST_SCALE of a movement point
+	static constexpr int COST_SCALE = 4;
+	static constexpr int BLOCKED = -1;
+
+	//Indexed by how many 60 degree turns the step needs, 0 to 3
+	int m_turnPenalty[4];
+	int m_turnInPlaceCost;
+
+	//Search workspace kept between searches, an entry only counts when its stamp matches m_searchStamp
+	std::vector<int> m_searchCost;
+	std::vector<int> m_searchParent;
+	std::vector<unsigned int> m_searchStamps;
+	unsigned int m_searchStamp;
+	//Bucket queue, m_buckets[f] holds the states pushed with that f
+	std::vector<std::vector<int>> m_buckets;
+	unsigned int m_expansions;
+	int m_lastCost;
+
+	static int toUnits(float cost);
+	static int getTurnSteps(int from, int to);
+	void prepareWorkspace(int stateCount);
+	int getSearchCost(int state) const { return m_searchStamps[state] == m_searchStamp ? m_searchCost[state] : INT_MAX; }
+	void push(int f, int state);
+public:
+	FacingPathfinder();
+
+	//Extra cost for a step needing turnSteps 60 degree turns (1 to 3), FLT_MAX forbids the turn
+	void setTurnPenalty(int turnSteps, float cost);
+	float getTurnPenalty(int turnSteps) const;
+	//Cost of each 60 degree turn without moving, FLT_MAX stops ships turning on the spot
+	void setTurnInPlaceCost(float cost);
+
+	//Route from src to dest inclusive, one state per move or turn. destFacing of -1 accepts any facing.
+	//Empty if there is no route.
+	std::vector<FacingState> findPath(const PathGrid& grid, std::pair<int, int> src, eDirection srcFacing,
+		std::pair<int, int> dest, int destFacing = -1, ePathPolicy policy = eAvoidShips);
+	//Cost of the last route found in movement points
+	float getLastCost() const;
+	//States expanded by the last search
+	unsigned int getExpansions() const { return m_expansions; }
+};
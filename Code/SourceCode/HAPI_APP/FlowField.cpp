@@ -0,0 +1,115 @@
+#include "FlowField.h"
+#include "PathGrid.h"
+#include <float.h>
+#include <functional>
+#include <queue>
+
+FlowField::FlowField(const PathGrid& grid, const std::vector<std::pair<int, int>>& goals, float maxCost) :
+	m_dimensions(grid.getDimensions()),
+	m_integration(grid.getSize(), FLT_MAX),
+	m_flow(grid.getSize(), -1),
+	m_goals(),
+	m_expansions(0)
+{
+	//open list contains pair <cost, tile index>
+	typedef std::pair<float, int> openEntry;
+	std::priority_queue<openEntry, std::vector<openEntry>, std::greater<openEntry>> openList;
+
+	for (const std::pair<int, int>& goal : goals)
+	{
+		if (!grid.inBounds(goal))
+			continue;
+		const int index = grid.getIndex(goal);
+		if (!grid.isNavigable(index) || m_integration[index] == 0.0f)
+			continue;
+		m_integration[index] = 0.0f;
+		m_goals.push_back(goal);
+		openList.push(openEntry(0.0f, index));
+	}
+
+	while (!openList.empty())
+	{
+		const openEntry p = openList.top();
+		openList.pop();
+		if (p.first > m_integration[p.second])
+			continue;
+		m_expansions++;
+
+		for (int direction = eNorth; direction <= eNorthWest; direction++)
+		{
+			const int adjacent = grid.getAdjacentIndex(p.second, direction);
+			if (adjacent == -1 || !grid.isNavigable(adjacent))
+				continue;
+
+			//Cost of a step is paid on entering the tile, so moving from adjacent onto p costs p's tile
+			const float sucCost = p.first + grid.getMovementCost(p.second);
+			if (sucCost > maxCost || sucCost >= m_integration[adjacent])
+				continue;
+
+			m_integration[adjacent] = sucCost;
+			//The adjacent tile steps back the opposite way onto p
+			m_flow[adjacent] = static_cast<signed char>((direction + 3) % 6);
+			openList.push(openEntry(sucCost, adjacent));
+		}
+	}
+}
+
+int FlowField::getIndex(std::pair<int, int> coord) const
+{
+	if (coord.first < 0 || coord.second < 0 ||
+		coord.first >= m_dimensions.first || coord.second >= m_dimensions.second)
+		return -1;
+	return coord.first + coord.second * m_dimensions.first;
+}
+
+bool FlowField::isGoal(std::pair<int, int> coord) const
+{
+	const int index = getIndex(coord);
+	return index != -1 && m_integration[index] == 0.0f;
+}
+
+bool FlowField::isReachable(std::pair<int, int> coord) const
+{
+	const int index = getIndex(coord);
+	return index != -1 && m_integration[index] != FLT_MAX;
+}
+
+float FlowField::getCost(std::pair<int, int> coord) const
+{
+	const int index = getIndex(coord);
+	if (index == -1)
+		return FLT_MAX;
+	return m_integration[index];
+}
+
+int FlowField::getDirection(std::pair<int, int> coord) const
+{
+	const int index = getIndex(coord);
+	if (index == -1)
+		return -1;
+	return m_flow[index];
+}
+
+std::pair<int, int> FlowField::getNextTile(std::pair<int, int> coord) const
+{
+	const int direction = getDirection(coord);
+	if (direction == -1)
+		return coord;
+	return PathGrid::getAdjacentCoordinate(coord, direction);
+}
+
+std::vector<std::pair<int, int>> FlowField::getPath(std::pair<int, int> start) const
+{
+	std::vector<std::pair<int, int>> path;
+	path.push_back(start);
+	if (!isReachable(start))
+		return path;
+
+	std::pair<int, int> current = start;
+	while (!isGoal(current))
+	{
+		current = getNextTile(current);
+		path.push_back(current);
+	}
+	return path;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <float.h>
+#include <utility>
+#include <vector>
+
+class PathGrid;
+
+//Shared route to one destination for any number of ships.
+//A single multi-source Dijkstra from the goal tiles fills in the integration field (cost to the nearest goal)
+//and the flow field (which neighbour to step onto next), so following it is a lookup per move.
+//Occupancy is ignored since the ships using the field are the ones in the way, moveEntity sorts out collisions.
+class FlowField
+{
+private:
+	std::pair<int, int> m_dimensions;
+	std::vector<float> m_integration;
+	std::vector<signed char> m_flow;
+	std::vector<std::pair<int, int>> m_goals;
+	unsigned int m_expansions;
+
+	int getIndex(std::pair<int, int> coord) const;
+public:
+	//maxCost limits how far out from the goals the field spreads, FLT_MAX covers the whole map
+	FlowField(const PathGrid& grid, const std::vector<std::pair<int, int>>& goals, float maxCost = FLT_MAX);
+
+	const std::vector<std::pair<int, int>>& getGoals() const { return m_goals; }
+	bool isGoal(std::pair<int, int> coord) const;
+	bool isReachable(std::pair<int, int> coord) const;
+	//Cost from this tile to the nearest goal, FLT_MAX if it can't get there
+	float getCost(std::pair<int, int> coord) const;
+	//eDirection of the next step, -1 on a goal or a tile that can't reach one
+	int getDirection(std::pair<int, int> coord) const;
+	//The tile to move onto next, returns coord itself on a goal or a tile that can't reach one
+	std::pair<int, int> getNextTile(std::pair<int, int> coord) const;
+	//Follows the field from start, the result ends on a goal (or is just start if none can be reached)
+	std::vector<std::pair<int, int>> getPath(std::pair<int, int> start) const;
+	//Tiles expanded while building the field
+	unsigned int getExpansions() const { return m_expansions; }
+};
@@ -0,0 +1,39 @@
+#include "HexDrawOrder.h"
+#include "Map.h"
+
+HexDrawOrder::HexDrawOrder(int mapWidth) :
+	m_mapWidth(mapWidth),
+	m_first(0, 0),
+	m_last(-1, -1),
+	m_order()
+{
+}
+
+void HexDrawOrder::buildOrder(std::pair<int, int> first, std::pair<int, int> last, int mapWidth, std::vector<int>& order)
+{
+	order.clear();
+	for (int y = first.second; y <= last.second; y++)
+	{
+		for (int parity = 1; parity >= 0; parity--)
+		{
+			for (int x = first.first + ((first.first & 1) != parity ? 1 : 0); x <= last.first; x += 2)
+				order.push_back(x + y * mapWidth);
+		}
+	}
+}
+
+const std::vector<int>& HexDrawOrder::getOrder(std::pair<int, int> first, std::pair<int, int> last)
+{
+	if (first == m_first && last == m_last)
+		return m_order;
+
+	m_first = first;
+	m_last = last;
+	buildOrder(first, last, m_mapWidth, m_order);
+	return m_order;
+}
+
+const std::vector<int>& HexDrawOrder::getOrder(const TileRange& range)
+{
+	return getOrder(range.m_first, range.m_last);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+struct TileRange;
+
+//Order tiles in a block of the map are drawn in so lower tiles cover the ones above them.
+//Tile frames are taller than a row, so each row's odd columns, which sit higher, go before its even columns.
+//Worked out once per block and kept until asked for a different one. Things on tiles are drawn at their tile's position in the order.
+class HexDrawOrder
+{
+private:
+	int m_mapWidth;
+	std::pair<int, int> m_first;
+	std::pair<int, int> m_last;
+	std::vector<int> m_order;
+public:
+	HexDrawOrder(int mapWidth);
+
+	//Fills order with the block's tile indices from first drawn to last, for blocks that are only drawn once
+	static void buildOrder(std::pair<int, int> first, std::pair<int, int> last, int mapWidth, std::vector<int>& order);
+
+	//Tile indices from first drawn to last, rebuilt only if the block differs from last time
+	const std::vector<int>& getOrder(std::pair<int, int> first, std::pair<int, int> last);
+	const std::vector<int>& getOrder(const TileRange& range);
+};
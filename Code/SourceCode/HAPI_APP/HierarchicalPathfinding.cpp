@@ -0,0 +1,492 @@
+#include "HierarchicalPathfinding.h"
+#include "PathGrid.h"
+#include <algorithm>
+#include <float.h>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+typedef std::pair<float, int> openEntry;
+typedef std::priority_queue<openEntry, std::vector<openEntry>, std::greater<openEntry>> openQueue;
+
+HierarchicalPathfinding::HierarchicalPathfinding(const PathGrid& grid, int chunkSize, TilePredicate navigable) :
+	m_grid(grid),
+	m_navigable(navigable ? navigable : &PathGrid::isNavigableType),
+	m_chunkSize(std::max(2, chunkSize)),
+	m_chunkCount(0, 0),
+	m_chunks(),
+	m_borders(),
+	m_dirtyChunks(),
+	m_dirty(false),
+	m_chunkCost(),
+	m_chunkParent()
+{
+	const std::pair<int, int> dimensions = m_grid.getDimensions();
+	m_chunkCount = std::pair<int, int>(
+		(dimensions.first + m_chunkSize - 1) / m_chunkSize,
+		(dimensions.second + m_chunkSize - 1) / m_chunkSize);
+	m_chunkCost.resize(m_chunkSize * m_chunkSize);
+	m_chunkParent.resize(m_chunkSize * m_chunkSize);
+	rebuild();
+}
+
+bool HierarchicalPathfinding::isNavigable(int tileIndex) const
+{
+	return m_navigable(m_grid.getType(tileIndex));
+}
+
+int HierarchicalPathfinding::getChunk(int tileIndex) const
+{
+	const std::pair<int, int> coord = m_grid.getCoordinate(tileIndex);
+	return coord.first / m_chunkSize + (coord.second / m_chunkSize) * m_chunkCount.first;
+}
+
+int HierarchicalPathfinding::getChunkLocalIndex(int chunk, int tileIndex) const
+{
+	const std::pair<int, int> coord = m_grid.getCoordinate(tileIndex);
+	return (coord.first - (chunk % m_chunkCount.first) * m_chunkSize) +
+		(coord.second - (chunk / m_chunkCount.first) * m_chunkSize) * m_chunkSize;
+}
+
+int HierarchicalPathfinding::getChunkTileIndex(int chunk, int localIndex) const
+{
+	return m_grid.getIndex(std::pair<int, int>(
+		(chunk % m_chunkCount.first) * m_chunkSize + localIndex % m_chunkSize,
+		(chunk / m_chunkCount.first) * m_chunkSize + localIndex / m_chunkSize));
+}
+
+std::vector<int> HierarchicalPathfinding::getNeighbourChunks(int chunk) const
+{
+	//Diagonal steps between hex columns can cross straight into a corner chunk, so all 8 are neighbours
+	std::vector<int> result;
+	const int chunkX = chunk % m_chunkCount.first;
+	const int chunkY = chunk / m_chunkCount.first;
+	for (int y = std::max(0, chunkY - 1); y <= std::min(m_chunkCount.second - 1, chunkY + 1); y++)
+	{
+		for (int x = std::max(0, chunkX - 1); x <= std::min(m_chunkCount.first - 1, chunkX + 1); x++)
+		{
+			if (x != chunkX || y != chunkY)
+				result.push_back(x + y * m_chunkCount.first);
+		}
+	}
+	return result;
+}
+
+std::vector<std::pair<int, int>> HierarchicalPathfinding::findEntrances(int chunk, int otherChunk) const
+{
+	const std::pair<int, int> dimensions = m_grid.getDimensions();
+	const int minX = (chunk % m_chunkCount.first) * m_chunkSize;
+	const int minY = (chunk / m_chunkCount.first) * m_chunkSize;
+	const int maxX = std::min(minX + m_chunkSize, dimensions.first) - 1;
+	const int maxY = std::min(minY + m_chunkSize, dimensions.second) - 1;
+
+	//Every step from this chunk onto the other
+	std::vector<std::pair<int, int>> crossings;
+	for (int y = minY; y <= maxY; y++)
+	{
+		for (int x = minX; x <= maxX; x++)
+		{
+			if (x != minX && x != maxX && y != minY && y != maxY)
+				continue;
+			const int tile = m_grid.getIndex(std::pair<int, int>(x, y));
+			if (!isNavigable(tile))
+				continue;
+			for (int direction = eNorth; direction <= eNorthWest; direction++)
+			{
+				const int adjacent = m_grid.getAdjacentIndex(tile, direction);
+				if (adjacent != -1 && isNavigable(adjacent) && getChunk(adjacent) == otherChunk)
+					crossings.push_back(std::pair<int, int>(tile, adjacent));
+			}
+		}
+	}
+
+	//Crossings were found tile by tile, so on top and bottom borders one tile's last crossing and the next tile's first
+	//aren't neighbours. Ordered along the border, and then by where they land, neighbouring crossings are consecutive.
+	const bool sameChunkRow = chunk / m_chunkCount.first == otherChunk / m_chunkCount.first;
+	std::sort(crossings.begin(), crossings.end(), [&](const std::pair<int, int>& a, const std::pair<int, int>& b)
+	{
+		const std::pair<int, int> aFrom = m_grid.getCoordinate(a.first);
+		const std::pair<int, int> bFrom = m_grid.getCoordinate(b.first);
+		const std::pair<int, int> aTo = m_grid.getCoordinate(a.second);
+		const std::pair<int, int> bTo = m_grid.getCoordinate(b.second);
+		if (sameChunkRow)
+			return std::make_pair(aFrom.second, aTo.second) < std::make_pair(bFrom.second, bTo.second);
+		return std::make_pair(aFrom.first, aTo.first) < std::make_pair(bFrom.first, bTo.first);
+	});
+
+	//Split the crossings into unbroken runs and place one or two entrances on each
+	std::vector<std::pair<int, int>> entrances;
+	size_t runStart = 0;
+	for (size_t i = 1; i <= crossings.size(); i++)
+	{
+		const bool runEnds = i == crossings.size() ||
+			PathGrid::getDistance(m_grid.getCoordinate(crossings[i - 1].first), m_grid.getCoordinate(crossings[i].first)) > 1 ||
+			PathGrid::getDistance(m_grid.getCoordinate(crossings[i - 1].second), m_grid.getCoordinate(crossings[i].second)) > 1;
+		if (!runEnds)
+			continue;
+
+		const size_t runLength = i - runStart;
+		if (runLength > LONG_ENTRANCE)
+		{
+			entrances.push_back(crossings[runStart]);
+			entrances.push_back(crossings[i - 1]);
+		}
+		else if (runLength > 0)
+		{
+			entrances.push_back(crossings[runStart + runLength / 2]);
+		}
+		runStart = i;
+	}
+	return entrances;
+}
+
+void HierarchicalPathfinding::buildBorder(int chunk, int otherChunk)
+{
+	const std::pair<int, int> key(std::min(chunk, otherChunk), std::max(chunk, otherChunk));
+	std::vector<std::pair<int, int>> entrances = findEntrances(key.first, key.second);
+	if (entrances.empty())
+		m_borders.erase(key);
+	else
+		m_borders[key] = entrances;
+}
+
+void HierarchicalPathfinding::buildChunkGraph(int chunk)
+{
+	Chunk& current = m_chunks[chunk];
+	current.m_nodes.clear();
+
+	const std::vector<int> neighbours = getNeighbourChunks(chunk);
+	for (int neighbour : neighbours)
+	{
+		auto border = m_borders.find(std::pair<int, int>(std::min(chunk, neighbour), std::max(chunk, neighbour)));
+		if (border == m_borders.end())
+			continue;
+		for (const std::pair<int, int>& entrance : border->second)
+			current.m_nodes.push_back(chunk < neighbour ? entrance.first : entrance.second);
+	}
+	std::sort(current.m_nodes.begin(), current.m_nodes.end());
+	current.m_nodes.erase(std::unique(current.m_nodes.begin(), current.m_nodes.end()), current.m_nodes.end());
+
+	const size_t nodeCount = current.m_nodes.size();
+	current.m_interEdges.assign(nodeCount, std::vector<std::pair<int, float>>());
+	for (int neighbour : neighbours)
+	{
+		auto border = m_borders.find(std::pair<int, int>(std::min(chunk, neighbour), std::max(chunk, neighbour)));
+		if (border == m_borders.end())
+			continue;
+		for (const std::pair<int, int>& entrance : border->second)
+		{
+			const int from = chunk < neighbour ? entrance.first : entrance.second;
+			const int to = chunk < neighbour ? entrance.second : entrance.first;
+			current.m_interEdges[findNodeSlot(chunk, from)].push_back(std::pair<int, float>(to, m_grid.getMovementCost(to)));
+		}
+	}
+
+	current.m_intraCost.assign(nodeCount * nodeCount, FLT_MAX);
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		searchChunk(chunk, current.m_nodes[i], -1, false);
+		for (size_t j = 0; j < nodeCount; j++)
+			current.m_intraCost[i * nodeCount + j] = m_chunkCost[getChunkLocalIndex(chunk, current.m_nodes[j])];
+	}
+}
+
+int HierarchicalPathfinding::findNodeSlot(int chunk, int tileIndex) const
+{
+	const std::vector<int>& nodes = m_chunks[chunk].m_nodes;
+	auto it = std::lower_bound(nodes.begin(), nodes.end(), tileIndex);
+	if (it == nodes.end() || *it != tileIndex)
+		return -1;
+	return static_cast<int>(it - nodes.begin());
+}
+
+void HierarchicalPathfinding::searchChunk(int chunk, int start, int goal, bool reverse)
+{
+	const std::pair<int, int> dimensions = m_grid.getDimensions();
+	const int minX = (chunk % m_chunkCount.first) * m_chunkSize;
+	const int minY = (chunk / m_chunkCount.first) * m_chunkSize;
+	const int maxX = std::min(minX + m_chunkSize, dimensions.first);
+	const int maxY = std::min(minY + m_chunkSize, dimensions.second);
+
+	std::fill(m_chunkCost.begin(), m_chunkCost.end(), FLT_MAX);
+	std::fill(m_chunkParent.begin(), m_chunkParent.end(), -1);
+
+	openQueue openList;
+	const int startLocal = getChunkLocalIndex(chunk, start);
+	m_chunkCost[startLocal] = 0.0f;
+	m_chunkParent[startLocal] = startLocal;
+	openList.push(openEntry(0.0f, startLocal));
+
+	while (!openList.empty())
+	{
+		const openEntry p = openList.top();
+		openList.pop();
+		if (p.first > m_chunkCost[p.second])
+			continue;
+
+		const std::pair<int, int> coord(minX + p.second % m_chunkSize, minY + p.second / m_chunkSize);
+		const int tile = m_grid.getIndex(coord);
+		if (tile == goal)
+			return;
+
+		for (int direction = eNorth; direction <= eNorthWest; direction++)
+		{
+			const std::pair<int, int> adjacentCoord = PathGrid::getAdjacentCoordinate(coord, direction);
+			if (adjacentCoord.first < minX || adjacentCoord.first >= maxX || adjacentCoord.second < minY || adjacentCoord.second >= maxY)
+				continue;
+			const int adjacent = m_grid.getIndex(adjacentCoord);
+			if (!isNavigable(adjacent))
+				continue;
+
+			//Going backwards the step is from adjacent onto tile, so it's tile's cost that is paid
+			const float sucCost = p.first + m_grid.getMovementCost(reverse ? tile : adjacent);
+			const int adjacentLocal = (adjacentCoord.first - minX) + (adjacentCoord.second - minY) * m_chunkSize;
+			if (sucCost < m_chunkCost[adjacentLocal])
+			{
+				m_chunkCost[adjacentLocal] = sucCost;
+				m_chunkParent[adjacentLocal] = p.second;
+				openList.push(openEntry(sucCost, adjacentLocal));
+			}
+		}
+	}
+}
+
+void HierarchicalPathfinding::onTileChanged(std::pair<int, int> coord, eTileChange change)
+{
+	if (change == eTerrainChange)
+		onTerrainChanged(coord);
+}
+
+void HierarchicalPathfinding::onTerrainChanged(std::pair<int, int> coord)
+{
+	if (!m_grid.inBounds(coord))
+		return;
+	m_dirtyChunks[getChunk(m_grid.getIndex(coord))] = true;
+	m_dirty = true;
+}
+
+void HierarchicalPathfinding::update()
+{
+	if (!m_dirty)
+		return;
+
+	//Borders first, so a chunk next to several changed ones has its graph built once
+	std::vector<bool> changed(m_chunks.size(), false);
+	for (int chunk = 0; chunk < static_cast<int>(m_dirtyChunks.size()); chunk++)
+	{
+		if (m_dirtyChunks[chunk])
+			rebuildBorders(chunk, changed);
+	}
+	for (int chunk = 0; chunk < static_cast<int>(changed.size()); chunk++)
+	{
+		if (changed[chunk])
+			buildChunkGraph(chunk);
+	}
+	std::fill(m_dirtyChunks.begin(), m_dirtyChunks.end(), false);
+	m_dirty = false;
+}
+
+void HierarchicalPathfinding::rebuildBorders(int chunk, std::vector<bool>& changed)
+{
+	changed[chunk] = true;
+	for (int neighbour : getNeighbourChunks(chunk))
+	{
+		const std::pair<int, int> key(std::min(chunk, neighbour), std::max(chunk, neighbour));
+		auto oldBorder = m_borders.find(key);
+		const std::vector<std::pair<int, int>> previous =
+			oldBorder == m_borders.end() ? std::vector<std::pair<int, int>>() : oldBorder->second;
+
+		buildBorder(chunk, neighbour);
+
+		auto newBorder = m_borders.find(key);
+		const bool isEmpty = newBorder == m_borders.end();
+		if ((isEmpty && !previous.empty()) || (!isEmpty && newBorder->second != previous))
+			changed[neighbour] = true;
+	}
+}
+
+void HierarchicalPathfinding::rebuild()
+{
+	m_borders.clear();
+	m_chunks.assign(m_chunkCount.first * m_chunkCount.second, Chunk());
+	m_dirtyChunks.assign(m_chunks.size(), false);
+	m_dirty = false;
+	for (int chunk = 0; chunk < static_cast<int>(m_chunks.size()); chunk++)
+	{
+		for (int neighbour : getNeighbourChunks(chunk))
+		{
+			if (neighbour > chunk)
+				buildBorder(chunk, neighbour);
+		}
+	}
+	for (int chunk = 0; chunk < static_cast<int>(m_chunks.size()); chunk++)
+		buildChunkGraph(chunk);
+}
+
+std::vector<std::pair<int, int>> HierarchicalPathfinding::findAbstractPath(std::pair<int, int> src, std::pair<int, int> dest)
+{
+	update();
+	std::vector<std::pair<int, int>> path;
+	if (!m_grid.inBounds(src) || !m_grid.inBounds(dest))
+		return path;
+
+	const int srcTile = m_grid.getIndex(src);
+	const int destTile = m_grid.getIndex(dest);
+	if (!isNavigable(srcTile) || !isNavigable(destTile))
+		return path;
+	if (srcTile == destTile)
+	{
+		path.push_back(src);
+		return path;
+	}
+
+	const int srcChunk = getChunk(srcTile);
+	const int destChunk = getChunk(destTile);
+
+	//Temporarily join src and dest to the entrances of their chunks
+	std::vector<std::pair<int, float>> srcEdges;
+	searchChunk(srcChunk, srcTile, -1, false);
+	for (int node : m_chunks[srcChunk].m_nodes)
+	{
+		const float cost = m_chunkCost[getChunkLocalIndex(srcChunk, node)];
+		if (cost != FLT_MAX)
+			srcEdges.push_back(std::pair<int, float>(node, cost));
+	}
+	if (srcChunk == destChunk && m_chunkCost[getChunkLocalIndex(srcChunk, destTile)] != FLT_MAX)
+		srcEdges.push_back(std::pair<int, float>(destTile, m_chunkCost[getChunkLocalIndex(srcChunk, destTile)]));
+
+	std::unordered_map<int, float> destCost;
+	searchChunk(destChunk, destTile, -1, true);
+	for (int node : m_chunks[destChunk].m_nodes)
+	{
+		const float cost = m_chunkCost[getChunkLocalIndex(destChunk, node)];
+		if (cost != FLT_MAX)
+			destCost[node] = cost;
+	}
+
+	std::unordered_map<int, float> g;
+	std::unordered_map<int, int> parent;
+	openQueue openList;
+	g[srcTile] = 0.0f;
+	parent[srcTile] = srcTile;
+	openList.push(openEntry(static_cast<float>(PathGrid::getDistance(src, dest)) * PathGrid::MIN_MOVEMENT_COST, srcTile));
+
+	std::vector<std::pair<int, float>> edges;
+	bool destFound = false;
+	while (!openList.empty())
+	{
+		const openEntry p = openList.top();
+		openList.pop();
+		const int current = p.second;
+		const float currentG = g[current];
+		if (p.first > currentG + static_cast<float>(PathGrid::getDistance(m_grid.getCoordinate(current), dest)) * PathGrid::MIN_MOVEMENT_COST)
+			continue;
+		if (current == destTile)
+		{
+			destFound = true;
+			break;
+		}
+
+		edges.clear();
+		if (current == srcTile)
+			edges.insert(edges.end(), srcEdges.begin(), srcEdges.end());
+
+		const int chunk = getChunk(current);
+		const int slot = findNodeSlot(chunk, current);
+		if (slot != -1)
+		{
+			const Chunk& currentChunk = m_chunks[chunk];
+			const size_t nodeCount = currentChunk.m_nodes.size();
+			for (size_t i = 0; i < nodeCount; i++)
+			{
+				const float cost = currentChunk.m_intraCost[slot * nodeCount + i];
+				if (cost != FLT_MAX && static_cast<int>(i) != slot)
+					edges.push_back(std::pair<int, float>(currentChunk.m_nodes[i], cost));
+			}
+			edges.insert(edges.end(), currentChunk.m_interEdges[slot].begin(), currentChunk.m_interEdges[slot].end());
+		}
+		if (chunk == destChunk)
+		{
+			auto toDest = destCost.find(current);
+			if (toDest != destCost.end())
+				edges.push_back(std::pair<int, float>(destTile, toDest->second));
+		}
+
+		for (const std::pair<int, float>& edge : edges)
+		{
+			const float sucG = currentG + edge.second;
+			auto existing = g.find(edge.first);
+			if (existing != g.end() && existing->second <= sucG)
+				continue;
+			g[edge.first] = sucG;
+			parent[edge.first] = current;
+			const float sucH = static_cast<float>(PathGrid::getDistance(m_grid.getCoordinate(edge.first), dest)) * PathGrid::MIN_MOVEMENT_COST;
+			openList.push(openEntry(sucG + sucH, edge.first));
+		}
+	}
+
+	if (!destFound)
+		return path;
+
+	for (int tile = destTile; tile != srcTile; tile = parent[tile])
+		path.push_back(m_grid.getCoordinate(tile));
+	path.push_back(src);
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+std::vector<std::pair<int, int>> HierarchicalPathfinding::refineSegment(std::pair<int, int> from, std::pair<int, int> to)
+{
+	std::vector<std::pair<int, int>> path;
+	const int fromTile = m_grid.getIndex(from);
+	const int toTile = m_grid.getIndex(to);
+	const int chunk = getChunk(fromTile);
+
+	//Consecutive waypoints in different chunks are a single step across the border
+	if (chunk != getChunk(toTile))
+	{
+		path.push_back(from);
+		path.push_back(to);
+		return path;
+	}
+
+	searchChunk(chunk, fromTile, toTile, false);
+	int local = getChunkLocalIndex(chunk, toTile);
+	if (m_chunkCost[local] == FLT_MAX)
+		return path;
+
+	while (m_chunkParent[local] != local)
+	{
+		path.push_back(m_grid.getCoordinate(getChunkTileIndex(chunk, local)));
+		local = m_chunkParent[local];
+	}
+	path.push_back(from);
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+std::vector<std::pair<int, int>> HierarchicalPathfinding::findPath(std::pair<int, int> src, std::pair<int, int> dest)
+{
+	const std::vector<std::pair<int, int>> waypoints = findAbstractPath(src, dest);
+	std::vector<std::pair<int, int>> path;
+	if (waypoints.empty())
+		return path;
+
+	path.push_back(waypoints[0]);
+	for (size_t i = 1; i < waypoints.size(); i++)
+	{
+		const std::vector<std::pair<int, int>> segment = refineSegment(waypoints[i - 1], waypoints[i]);
+		if (segment.empty())
+			return std::vector<std::pair<int, int>>();
+		path.insert(path.end(), segment.begin() + 1, segment.end());
+	}
+	return path;
+}
+
+int HierarchicalPathfinding::getNodeCount() const
+{
+	int count = 0;
+	for (const Chunk& chunk : m_chunks)
+		count += static_cast<int>(chunk.m_nodes.size());
+	return count;
+}
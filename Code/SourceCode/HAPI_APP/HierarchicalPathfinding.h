@@ -0,0 +1,81 @@
+#pragma once
+#include <map>
+#include <utility>
+#include <vector>
+#include "MapListener.h"
+#include "PathGrid.h"
+
+//HPA* over square chunks of the map for long voyages.
+//Entrances are placed along each border between neighbouring chunks and the costs between the entrances
+//of a chunk are precomputed, so a long route is an A* over the entrances followed by short searches inside
+//single chunks that are only run when that part of the route is needed.
+//Ships are ignored, tiles are crossed wherever the tile predicate allows, PathGrid::isNavigableType by default.
+class HierarchicalPathfinding : public IMapListener
+{
+public:
+	typedef bool(*TilePredicate)(eTileType type);
+private:
+	//Runs of border crossings longer than this get an entrance at both ends rather than one in the middle
+	static constexpr int LONG_ENTRANCE = 6;
+
+	struct Chunk
+	{
+		//Tile indices of the entrances in this chunk
+		std::vector<int> m_nodes;
+		//Cost between every pair of entrances without leaving the chunk, m_nodes.size() squared, FLT_MAX if not connected
+		std::vector<float> m_intraCost;
+		//Per entrance, the entrances in neighbouring chunks it steps straight onto and the cost of doing so
+		std::vector<std::vector<std::pair<int, float>>> m_interEdges;
+	};
+
+	const PathGrid& m_grid;
+	TilePredicate m_navigable;
+	int m_chunkSize;
+	std::pair<int, int> m_chunkCount;
+	std::vector<Chunk> m_chunks;
+	//Keyed by (lower chunk, higher chunk), the entrance crossings as (tile in lower, tile in higher)
+	std::map<std::pair<int, int>, std::vector<std::pair<int, int>>> m_borders;
+
+	//Chunks with terrain changes not yet rebuilt
+	std::vector<bool> m_dirtyChunks;
+	bool m_dirty;
+
+	//Reused by the searches inside a chunk
+	std::vector<float> m_chunkCost;
+	std::vector<int> m_chunkParent;
+
+	bool isNavigable(int tileIndex) const;
+	int getChunk(int tileIndex) const;
+	std::vector<int> getNeighbourChunks(int chunk) const;
+	std::vector<std::pair<int, int>> findEntrances(int chunk, int otherChunk) const;
+	void buildBorder(int chunk, int otherChunk);
+	void buildChunkGraph(int chunk);
+	int findNodeSlot(int chunk, int tileIndex) const;
+	//Dijkstra that never leaves the chunk. Reverse gives the cost of reaching start rather than leaving it.
+	//Fills m_chunkCost and m_chunkParent, indexed by position within the chunk.
+	void searchChunk(int chunk, int start, int goal, bool reverse);
+	int getChunkLocalIndex(int chunk, int tileIndex) const;
+	int getChunkTileIndex(int chunk, int localIndex) const;
+	//Rebuilds the borders of a chunk, adding it and any neighbour whose shared entrances moved to changed
+	void rebuildBorders(int chunk, std::vector<bool>& changed);
+public:
+	HierarchicalPathfinding(const PathGrid& grid, int chunkSize = 16, TilePredicate navigable = &PathGrid::isNavigableType);
+
+	//Register with Map::addListener, or call onTerrainChanged, so terrain changes are patched in
+	void onTileChanged(std::pair<int, int> coord, eTileChange change) override;
+	//Marks the tile's chunk to be rebuilt by the next update or search
+	void onTerrainChanged(std::pair<int, int> coord);
+	//Rebuilds the changed chunks, and neighbours whose shared entrances moved. Searches call it themselves.
+	void update();
+	void rebuild();
+
+	//Search over the entrances only. Returns src, the entrances passed through and dest, empty if there's no route.
+	std::vector<std::pair<int, int>> findAbstractPath(std::pair<int, int> src, std::pair<int, int> dest);
+	//Full resolution tiles between two consecutive waypoints of an abstract path, from first to second inclusive
+	std::vector<std::pair<int, int>> refineSegment(std::pair<int, int> from, std::pair<int, int> to);
+	//Abstract search followed by refining every segment, from src to dest inclusive
+	std::vector<std::pair<int, int>> findPath(std::pair<int, int> src, std::pair<int, int> dest);
+
+	int getChunkSize() const { return m_chunkSize; }
+	int getNodeCount() const;
+};
@@ -1,4 +1,6 @@
 #include "Map.h"
+#include "Entity.h"
+#include "DrawList.h"
 #include <memory>
 #include <math.h>
 #include <algorithm>
@@ -7,43 +9,62 @@
 
 constexpr int FRAME_HEIGHT = 28;
 
-void Map::drawMap() const 
+void Map::drawMap(DrawList& drawList) const 
+{
+	updateTileSprites();
+	m_terrainChunks.draw(m_data, getVisibleTileRange(), m_drawScale, m_drawOffset, drawList);
+}
+
+void Map::updateTileSprites() const
+{
+	if (m_placedOffset != m_drawOffset || m_placedScale != m_drawScale)
+		placeTileSprites(getVisibleTileRange());
+}
+
+void Map::placeTileSprites(const TileRange& visible) const
 {
 	std::pair<int, int> textureDimensions = std::pair<int, int>(
 		m_data[0].m_sprite->FrameWidth(),
 		FRAME_HEIGHT);
 		//m_data[0].m_sprite->FrameHeight());
 
-	int access{ 0 };
-	for (int y = 0; y < m_mapDimensions.second; y++)
+	for (int y = visible.m_first.second; y <= visible.m_last.second; y++)
 	{
+		const int access = y * m_mapDimensions.first;
 		const float yPosEven = (float)(0.5 + y) * textureDimensions.second;
 		const float yPosOdd = (float)y * textureDimensions.second;
 
-		for (int x = 1; x < m_mapDimensions.first; x += 2)
-		{
-			const float xPos = (float)x * textureDimensions.first * 3 / 4;
-			//Is Odd
-			m_data[access + x].m_sprite->GetTransformComp().SetPosition(HAPISPACE::VectorF(
-				xPos * m_drawScale - m_drawOffset.first,
-				yPosOdd * m_drawScale - m_drawOffset.second));
-			m_data[access + x].m_sprite->GetTransformComp().SetScaling(
-				HAPISPACE::VectorF(m_drawScale, m_drawScale));
-			m_data[access + x].m_sprite->Render(SCREEN_SURFACE);
-		}
-		for (int x = 0; x < m_mapDimensions.first; x += 2)
+		for (int x = visible.m_first.first; x <= visible.m_last.first; x++)
 		{
 			const float xPos = (float)x * textureDimensions.first * 3 / 4;
-			//Is even
 			m_data[access + x].m_sprite->GetTransformComp().SetPosition(HAPISPACE::VectorF(
 				xPos * m_drawScale - m_drawOffset.first,
-				yPosEven * m_drawScale - m_drawOffset.second));
+				((x & 1) ? yPosOdd : yPosEven) * m_drawScale - m_drawOffset.second));
 			m_data[access + x].m_sprite->GetTransformComp().SetScaling(
 				HAPISPACE::VectorF(m_drawScale, m_drawScale));
-			m_data[access + x].m_sprite->Render(SCREEN_SURFACE);
 		}
-		access += m_mapDimensions.first;
 	}
+	m_placedOffset = m_drawOffset;
+	m_placedScale = m_drawScale;
+}
+
+TileRange Map::getVisibleTileRange() const
+{
+	//Sprites are a full frame high, taller than the row spacing, and even columns sit half a row lower
+	const float frameWidth = (float)m_data[0].m_sprite->FrameWidth();
+	const float frameHeight = (float)m_data[0].m_sprite->FrameHeight();
+	const float columnSpacing = frameWidth * 3 / 4;
+	const float left = m_drawOffset.first / m_drawScale;
+	const float top = m_drawOffset.second / m_drawScale;
+	const float right = (SCREEN_SURFACE->Width() + m_drawOffset.first) / m_drawScale;
+	const float bottom = (SCREEN_SURFACE->Height() + m_drawOffset.second) / m_drawScale;
+
+	TileRange range;
+	range.m_first.first = std::max(0, (int)floor((left - frameWidth) / columnSpacing) + 1);
+	range.m_last.first = std::min(m_mapDimensions.first - 1, (int)ceil(right / columnSpacing) - 1);
+	range.m_first.second = std::max(0, (int)floor((top - frameHeight) / FRAME_HEIGHT - 0.5f) + 1);
+	range.m_last.second = std::min(m_mapDimensions.second - 1, (int)ceil(bottom / FRAME_HEIGHT) - 1);
+	return range;
 }
 
 std::pair<int, int> Map::offsetToCube(std::pair<int, int> offset) const
@@ -121,23 +142,10 @@ std::vector<Tile*> Map::getAdjacentTiles(std::pair<int, int> coord)
 {
 	std::vector<Tile*> result;
 	result.reserve(size_t(6));
-	if (coord.first & 1)//Is an odd tile
-	{
-		result.push_back(getTile(std::pair<int, int>(coord.first, coord.second - 1)));		//N
-		result.push_back(getTile(std::pair<int, int>(coord.first + 1, coord.second - 1)));	//NE
-		result.push_back(getTile(std::pair<int, int>(coord.first + 1, coord.second)));		//SE
-		result.push_back(getTile(std::pair<int, int>(coord.first, coord.second + 1)));		//S
-		result.push_back(getTile(std::pair<int, int>(coord.first - 1, coord.second)));		//SW
-		result.push_back(getTile(std::pair<int, int>(coord.first - 1, coord.second - 1)));	//NW
-	}
-	else//Is even
+	//N, NE, SE, S, SW, NW
+	for (int direction = eNorth; direction <= eNorthWest; direction++)
 	{
-		result.push_back(getTile(std::pair<int, int>(coord.first, coord.second - 1)));		//N
-		result.push_back(getTile(std::pair<int, int>(coord.first + 1, coord.second)));		//NE
-		result.push_back(getTile(std::pair<int, int>(coord.first + 1, coord.second + 1)));	//SE
-		result.push_back(getTile(std::pair<int, int>(coord.first, coord.second + 1)));		//S
-		result.push_back(getTile(std::pair<int, int>(coord.first - 1, coord.second + 1)));	//SW
-		result.push_back(getTile(std::pair<int, int>(coord.first - 1, coord.second)));		//NW
+		result.push_back(getTile(PathGrid::getAdjacentCoordinate(coord, direction)));
 	}
 	return result;
 }
@@ -231,6 +239,11 @@ bool Map::moveEntity(std::pair<int, int> originalPos, std::pair<int, int> newPos
 
 	getTile(newPos)->m_entityOnTile = tmpOld;
 	getTile(originalPos)->m_entityOnTile = nullptr;
+	m_pathGrid.setOccupied(m_pathGrid.getIndex(newPos), true);
+	m_pathGrid.setOccupied(m_pathGrid.getIndex(originalPos), false);
+	rebuildZonesOfControl();
+	notifyTileChanged(originalPos, eOccupancyChange);
+	notifyTileChanged(newPos, eOccupancyChange);
 	return true;
 }
 
@@ -240,9 +253,76 @@ void Map::insertEntity(Entity * newEntity, std::pair<int, int> coord)
 	if (tile && !tile->m_entityOnTile)
 	{
 		tile->m_entityOnTile = newEntity;
+		m_pathGrid.setOccupied(m_pathGrid.getIndex(coord), true);
+		rebuildZonesOfControl();
+		notifyTileChanged(coord, eOccupancyChange);
+	}
+}
+
+bool Map::setTileType(std::pair<int, int> coord, eTileType type)
+{
+	Tile* tile = getTile(coord);
+	if (!tile)
+		return false;
+
+	tile->m_type = type;
+	tile->m_sprite->SetFrameNumber(type);
+	m_pathGrid.setType(m_pathGrid.getIndex(coord), type);
+	m_terrainChunks.onTerrainChanged(coord);
+	notifyTileChanged(coord, eTerrainChange);
+	return true;
+}
+
+void Map::addListener(IMapListener* listener)
+{
+	if (listener && std::find(m_listeners.begin(), m_listeners.end(), listener) == m_listeners.end())
+		m_listeners.push_back(listener);
+}
+
+void Map::removeListener(IMapListener* listener)
+{
+	m_listeners.erase(std::remove(m_listeners.begin(), m_listeners.end(), listener), m_listeners.end());
+}
+
+void Map::notifyTileChanged(std::pair<int, int> coord, eTileChange change)
+{
+	for (IMapListener* listener : m_listeners)
+		listener->onTileChanged(coord, change);
+}
+
+void Map::rebuildZonesOfControl()
+{
+	std::vector<std::pair<int, int>> shipsOfFaction[FACTION_COUNT];
+	for (const Tile& tile : m_data)
+	{
+		if (tile.m_entityOnTile)
+			shipsOfFaction[static_cast<int>(tile.m_entityOnTile->getFaction())].push_back(tile.m_tileCoordinate);
+	}
+
+	std::vector<std::pair<int, int>> enemyShips;
+	for (int movingFaction = 0; movingFaction < FACTION_COUNT; movingFaction++)
+	{
+		enemyShips.clear();
+		for (int otherFaction = 0; otherFaction < FACTION_COUNT; otherFaction++)
+		{
+			if (otherFaction != movingFaction)
+				enemyShips.insert(enemyShips.end(), shipsOfFaction[otherFaction].begin(), shipsOfFaction[otherFaction].end());
+		}
+		m_zonesOfControl[movingFaction].build(m_pathGrid, enemyShips);
 	}
 }
 
+const ZoneOfControl& Map::getZoneOfControl(faction movingFaction) const
+{
+	return m_zonesOfControl[static_cast<int>(movingFaction)];
+}
+
+void Map::setZoneOfControlRule(eZocRule rule, float extraCost)
+{
+	for (ZoneOfControl& zone : m_zonesOfControl)
+		zone.setRule(rule, extraCost);
+}
+
 std::pair<int, int> Map::getTileScreenPos(std::pair<int, int> coord) const
 {
 	std::pair<int, int> textureDimensions = std::pair<int, int>(
@@ -261,6 +341,12 @@ std::pair<int, int> Map::getTileScreenPos(std::pair<int, int> coord) const
 Map::Map(std::pair<int, int> size, const std::vector<std::vector<int>>& tileData) :
 	m_mapDimensions(size),
 	m_data(),
+	m_pathGrid(size),
+	m_listeners(),
+	m_zonesOfControl(FACTION_COUNT),
+	m_terrainChunks(size, FRAME_HEIGHT),
+	m_placedOffset(0, 0),
+	m_placedScale(0.0f),
 	m_drawOffset(std::pair<int, int>(10, 60)),
 	m_windDirection(eNorth),
 	m_windStrength(0.0),
@@ -285,6 +371,7 @@ Map::Map(std::pair<int, int> size, const std::vector<std::vector<int>>& tileData
 				return;
 			}
 			m_data[x + y * m_mapDimensions.first].m_sprite->SetFrameNumber(tileID);
+			m_pathGrid.setType(x + y * m_mapDimensions.first, static_cast<eTileType>(tileID));
 			//cubeToOffset(offsetToCube(std::pair<int, int>(x, y)));
 		}
 	}
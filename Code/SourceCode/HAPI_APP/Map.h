@@ -5,8 +5,14 @@
 #include <HAPISprites_lib.h>
 #include <HAPISprites_UI.h>
 #include "global.h"
+#include "PathGrid.h"
+#include "MapListener.h"
+#include "TerrainChunkCache.h"
+#include "ZoneOfControl.h"
 
 class Entity;
+class DrawList;
+enum class faction;
 
 struct Tile
 {
@@ -38,6 +44,15 @@ struct Tile
 	}
 };
 
+//Inclusive range of tile coordinates, empty if last is before first on either axis
+struct TileRange
+{
+	std::pair<int, int> m_first;
+	std::pair<int, int> m_last;
+
+	bool isEmpty() const { return m_last.first < m_first.first || m_last.second < m_first.second; }
+};
+
 class Map
 {
 private:
@@ -48,11 +63,24 @@ private:
 	std::pair<int, int> m_drawOffset;
 	std::unique_ptr<HAPISPACE::Sprite> motherSprite; //All tiles inherit from this sprite
 	std::vector<Tile> m_data;
+	PathGrid m_pathGrid;
+	std::vector<IMapListener*> m_listeners;
+	//Per faction, the tiles next to ships of any other faction. Rebuilt as soon as a ship is placed or moves
+	std::vector<ZoneOfControl> m_zonesOfControl;
+	//Terrain baked into chunks so drawMap doesn't draw every tile every frame
+	mutable TerrainChunkCache m_terrainChunks;
+	//Camera the visible tile sprites were last positioned for, they are only moved again when it changes
+	mutable std::pair<int, int> m_placedOffset;
+	mutable float m_placedScale;
 
 	std::pair<int, int> offsetToCube(std::pair<int, int> offset) const;
 	std::pair<int, int> cubeToOffset(std::pair<int, int> cube) const;
 	int cubeDistance(std::pair<int, int> a, std::pair<int, int> b) const;
+	void notifyTileChanged(std::pair<int, int> coord, eTileChange change);
+	void rebuildZonesOfControl();
 	bool inCone(std::pair<int, int> orgHex, std::pair<int, int> testHex, eDirection dir) const;
+	//Tile sprites aren't drawn directly any more but are still positioned on screen for mouse collisions
+	void placeTileSprites(const TileRange& visible) const;
 public:
 	//Returns a pointer to a given tile, returns nullptr if there is no tile there
 	Tile *getTile(std::pair<int, int> coordinate);
@@ -64,18 +92,31 @@ public:
 	std::vector<Tile*> getTileCone(std::pair<int, int> coord, int range, eDirection direction);
 
 	std::pair<int, int> getTileScreenPos(std::pair<int, int> coord) const;
+	//Tiles with any part of their sprite on screen for the current draw offset and scale
+	TileRange getVisibleTileRange() const;
 
 	//Moves an entitys position on the map, returns false if the position is already taken
 	bool moveEntity(std::pair<int, int> originalPos, std::pair<int, int> newPos);
 	//Places a new entity on the map (no check for duplicates yet so try to avoid creating multiples)
 	void insertEntity(Entity* newEntity, std::pair<int, int> coord);
+	//Changes the terrain of a tile, returns false if there is no tile there
+	bool setTileType(std::pair<int, int> coord, eTileType type);
+
+	//Listeners are told about every occupancy and terrain change, they must remove themselves before being destroyed
+	void addListener(IMapListener* listener);
+	void removeListener(IMapListener* listener);
 
-	void drawMap() const;
+	//Adds the visible terrain to the draw list
+	void drawMap(DrawList& drawList) const;
+	//Positions the visible tile sprites for the current camera so they can be used for collisions, drawMap does this too
+	void updateTileSprites() const;
 	std::pair<int, int> getDrawOffset() const { return m_drawOffset; }
 	void setDrawOffset(std::pair<int, int> newOffset) { m_drawOffset = newOffset; }
 
 	float getDrawScale() const { return m_drawScale; }
 	void setDrawScale(float scale) { if (scale > 0.0) m_drawScale = scale; }
+	//Leaves out the parts of tiles that lower tiles cover when terrain is baked, see TerrainChunkCache
+	void setSkipCoveredTilePixels(bool skip) { m_terrainChunks.setSkipCoveredPixels(skip); }
 
 	float getWindStrength() const { return m_windStrength; }
 	void setWindStrength(float strength) { if (strength > 0.0) m_windStrength = strength; }
@@ -85,6 +126,12 @@ public:
 	
 	//TODO: remove later
 	std::vector<Tile>* getMap() { return &m_data; }
+	std::pair<int, int> getMapDimensions() const { return m_mapDimensions; }
+	//Terrain and occupancy mirror used by Pathfinding
+	const PathGrid& getPathGrid() const { return m_pathGrid; }
+	//Zone of control the given faction moves under, never out of date so worker threads can read it while ships aren't moving
+	const ZoneOfControl& getZoneOfControl(faction movingFaction) const;
+	void setZoneOfControlRule(eZocRule rule, float extraCost = ZoneOfControl::DEFAULT_EXTRA_COST);
 
 	//TODO: Get constructor working. Need tiled parser or load from xml set up
 	Map(std::pair<int, int> size, const std::vector<std::vector<int>>& tileData);
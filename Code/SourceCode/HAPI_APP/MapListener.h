@@ -0,0 +1,16 @@
+#pragma once
+#include <utility>
+
+enum eTileChange
+{
+	eOccupancyChange,
+	eTerrainChange
+};
+
+//Implement and register with Map::addListener to be told when a tile changes
+class IMapListener
+{
+public:
+	virtual ~IMapListener() {}
+	virtual void onTileChanged(std::pair<int, int> coord, eTileChange change) = 0;
+};
@@ -0,0 +1,196 @@
+#include "Minimap.h"
+#include "DrawList.h"
+#include "Entity.h"
+#include "Map.h"
+#include <algorithm>
+
+using namespace HAPISPACE;
+
+namespace
+{
+	const Colour255 FOG_COLOUR(20, 20, 24);
+
+	Colour255 getTerrainColour(eTileType type)
+	{
+		switch (type)
+		{
+		case eGrass:
+		case eFarm:
+			return Colour255(96, 160, 64);
+		case eSparseForest:
+		case eJungle:
+			return Colour255(56, 128, 48);
+		case eForest:
+		case eWoodedFoothills:
+			return Colour255(32, 92, 36);
+		case eFoothills:
+			return Colour255(132, 124, 80);
+		case eMountain:
+		case eMesa:
+			return Colour255(120, 110, 104);
+		case eSea:
+		case eLeftPort:
+		case eRightPort:
+			return Colour255(48, 96, 176);
+		case eOcean:
+			return Colour255(28, 56, 128);
+		case eWoodedSwamp:
+		case eSwampPools:
+		case eSwamp:
+		case eSwampWater:
+		case eSwampRuins:
+			return Colour255(72, 96, 64);
+		case eSnow:
+		case eSnowFoothills:
+			return Colour255(232, 236, 240);
+		case eSparseSnowForest:
+		case eSnowForest:
+		case eSnowWoodedFoothills:
+			return Colour255(176, 196, 188);
+		case eIceburgs:
+			return Colour255(168, 208, 232);
+		case eSand:
+		case eSandDunes:
+		case eSandFoothills:
+			return Colour255(216, 192, 128);
+		case eOasis:
+			return Colour255(80, 168, 160);
+		case eGrasslandTown:
+		case eWalledGrasslandTown:
+		case eStoneGrasslandTown:
+		case eSnowTown:
+		case eSnowCastle:
+		case eSandTown:
+		case eWalledSandTown:
+		case eLighthouse:
+		case eGrasslandRuin:
+			return Colour255(168, 80, 56);
+		default:
+			return Colour255::BLACK;
+		}
+	}
+
+	Colour255 getFactionColour(faction shipFaction)
+	{
+		switch (shipFaction)
+		{
+		case faction::eFaction1:
+			return Colour255(255, 48, 48);
+		case faction::eFaction2:
+			return Colour255(255, 220, 32);
+		case faction::eFaction3:
+			return Colour255(200, 64, 255);
+		default:
+			return Colour255(255, 255, 255);
+		}
+	}
+}
+
+Minimap::Minimap(Map& map) :
+	m_map(map),
+	m_mapDimensions(map.getMapDimensions()),
+	m_tilesPerPixel(1),
+	m_size(),
+	m_drawScale(1),
+	m_fogged(map.getMapDimensions().first * map.getMapDimensions().second, false),
+	m_copies(),
+	m_nextCopy(0),
+	m_changed(true)
+{
+	const int longestSide = std::max(m_mapDimensions.first, m_mapDimensions.second);
+	m_tilesPerPixel = std::max(1, (longestSide + MAX_SIZE - 1) / MAX_SIZE);
+	m_size = std::pair<int, int>(
+		std::max(1, (m_mapDimensions.first + m_tilesPerPixel - 1) / m_tilesPerPixel),
+		std::max(1, (m_mapDimensions.second + m_tilesPerPixel - 1) / m_tilesPerPixel));
+	m_drawScale = std::min(MAX_DRAW_SCALE, std::max(1, MAX_SIZE / std::max(m_size.first, m_size.second)));
+
+	//Built once here, every change after is a patch
+	const int pixelCount = m_size.first * m_size.second;
+	m_copies[0].m_surface = std::make_shared<Surface>(m_size.first, m_size.second);
+	for (int pixel = 0; pixel < pixelCount; pixel++)
+		m_copies[0].m_surface->SetPixelFast(VectorI(pixel % m_size.first, pixel / m_size.first), getPixelColour(pixel));
+	m_copies[1].m_surface = m_copies[0].m_surface->MakeCopy();
+	for (Copy& copy : m_copies)
+		copy.m_queued.assign(pixelCount, false);
+}
+
+int Minimap::getPixel(std::pair<int, int> coord) const
+{
+	return coord.first / m_tilesPerPixel + (coord.second / m_tilesPerPixel) * m_size.first;
+}
+
+Colour255 Minimap::getPixelColour(int pixel) const
+{
+	const int firstX = (pixel % m_size.first) * m_tilesPerPixel;
+	const int firstY = (pixel / m_size.first) * m_tilesPerPixel;
+	const int lastX = std::min(firstX + m_tilesPerPixel, m_mapDimensions.first);
+	const int lastY = std::min(firstY + m_tilesPerPixel, m_mapDimensions.second);
+	const std::vector<Tile>& tiles = *m_map.getMap();
+
+	//A ship anywhere in the block shows over the terrain, which is taken from the first tile that isn't fogged
+	int terrainTile = -1;
+	for (int y = firstY; y < lastY; y++)
+	{
+		for (int x = firstX; x < lastX; x++)
+		{
+			const int index = x + y * m_mapDimensions.first;
+			if (m_fogged[index])
+				continue;
+			if (tiles[index].m_entityOnTile)
+				return getFactionColour(tiles[index].m_entityOnTile->getFaction());
+			if (terrainTile == -1)
+				terrainTile = index;
+		}
+	}
+	return terrainTile == -1 ? FOG_COLOUR : getTerrainColour(tiles[terrainTile].m_type);
+}
+
+void Minimap::queuePixel(int pixel)
+{
+	for (Copy& copy : m_copies)
+	{
+		if (!copy.m_queued[pixel])
+		{
+			copy.m_queued[pixel] = true;
+			copy.m_pending.push_back(pixel);
+		}
+	}
+	m_changed = true;
+}
+
+void Minimap::onTileChanged(std::pair<int, int> coord, eTileChange change)
+{
+	queuePixel(getPixel(coord));
+}
+
+void Minimap::setFogged(std::pair<int, int> coord, bool fogged)
+{
+	const int index = coord.first + coord.second * m_mapDimensions.first;
+	if (m_fogged[index] == fogged)
+		return;
+	m_fogged[index] = fogged;
+	queuePixel(getPixel(coord));
+}
+
+void Minimap::draw(DrawList& drawList, std::pair<int, int> position)
+{
+	Copy& copy = m_copies[m_nextCopy];
+	m_nextCopy = 1 - m_nextCopy;
+	for (int pixel : copy.m_pending)
+	{
+		copy.m_surface->SetPixelFast(VectorI(pixel % m_size.first, pixel / m_size.first), getPixelColour(pixel));
+		copy.m_queued[pixel] = false;
+	}
+	copy.m_pending.clear();
+
+	Transform transform(VectorF((float)position.first, (float)position.second));
+	transform.scale = VectorF((float)m_drawScale, (float)m_drawScale);
+	drawList.add(eLayerUI, -1.0f, copy.m_surface, RectangleI(m_size.first, m_size.second), transform);
+}
+
+bool Minimap::takeChanged()
+{
+	const bool changed = m_changed;
+	m_changed = false;
+	return changed;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+#include <HAPISprites_lib.h>
+#include "MapListener.h"
+
+class DrawList;
+class Map;
+
+//The whole map at about a pixel per hex, coloured by terrain with ships in their faction's colour and fogged tiles dark.
+//Maps too big for MAX_SIZE pixels have each pixel cover a square block of tiles, showing a ship if any is in the block.
+//Built once, then only pixels of tiles reported changed are worked out again, the next time it is drawn.
+//There are two copies, patched in turn, so the copy the frame on screen is drawing from is never written to.
+class Minimap : public IMapListener
+{
+private:
+	struct Copy
+	{
+		std::shared_ptr<HAPISPACE::Surface> m_surface;
+		//Pixels changed since this copy was last drawn
+		std::vector<int> m_pending;
+		std::vector<bool> m_queued;
+	};
+
+	Map& m_map;
+	std::pair<int, int> m_mapDimensions;
+	//Tiles across each pixel covers
+	int m_tilesPerPixel;
+	std::pair<int, int> m_size;
+	//Small maps are drawn scaled up so they aren't lost in the corner
+	int m_drawScale;
+	std::vector<bool> m_fogged;
+	Copy m_copies[2];
+	int m_nextCopy;
+	bool m_changed;
+
+	int getPixel(std::pair<int, int> coord) const;
+	HAPISPACE::Colour255 getPixelColour(int pixel) const;
+	void queuePixel(int pixel);
+public:
+	//Largest the minimap is drawn, in pixels across
+	static constexpr int MAX_SIZE = 200;
+	static constexpr int MAX_DRAW_SCALE = 4;
+
+	Minimap(Map& map);
+
+	void onTileChanged(std::pair<int, int> coord, eTileChange change) override;
+	//Fogged tiles show as unexplored whatever is on them
+	void setFogged(std::pair<int, int> coord, bool fogged);
+
+	//Patches the copy being drawn this frame and adds it to the UI layer, under the window sprites
+	void draw(DrawList& drawList, std::pair<int, int> position);
+	//True once after any tile shown on the minimap changes, to mark its area for redrawing
+	bool takeChanged();
+	//Size on screen in pixels
+	std::pair<int, int> getSize() const { return std::pair<int, int>(m_size.first * m_drawScale, m_size.second * m_drawScale); }
+};
@@ -1,5 +1,12 @@
 #include "OverworldUI.h"
 
+namespace
+{
+	const HAPISPACE::RectangleI PREBATTLE_WINDOW_AREA(220, 1050, 510, 710);
+	const int DIFFICULTY_TEXT = 0;
+	const int DIFFICULTY_TEXT_SIZE = 90;
+}
+
 OverworldUI::OverworldUI()
 {
 }
@@ -56,7 +63,8 @@ bool OverworldUIWIndowTest::Initialise()
 		m_entityVector.push_back(newEntity);
 	}
 
-	UI.AddWindow("testWindow", HAPISPACE::RectangleI(220, 1050, 510, 710));
+	UI.AddWindow("testWindow", PREBATTLE_WINDOW_AREA);
+	m_dirtyRegions.addOverlay(DirtyRegionTracker::FPS_COUNTER_AREA);
 	for (int i = 0; i < m_entityVector.size(); i++)
 	{
 		UI.GetWindow("testWindow")->AddCanvas("entity" + std::to_string(i), HAPISPACE::RectangleI(50 * i, (50 * i) + 50, 0, 100), m_entityVector[i].getSpritePtr());
@@ -67,14 +75,26 @@ bool OverworldUIWIndowTest::Initialise()
 
 void OverworldUIWIndowTest::Update()
 {
-	SCREEN_SURFACE->Clear();
+	//Sprites only change when hovered over or when the prebattle window opens and closes
+	m_dirtyRegions.trackSprite(*BattleMapBackground);
+	m_dirtyRegions.trackSprite(*EnemyTerritoryHexSheet);
+	m_dirtyRegions.trackSprite(*PrebattleUIBackground, testPrebattleWindow);
+	m_dirtyRegions.trackSprite(*PlayButton, testPrebattleWindow);
+	m_dirtyRegions.trackSprite(*BackButton, testPrebattleWindow);
+	const std::string difficultyText = EnemyTerritoryHexSheet->GetFrameNumber() == 0 ? std::to_string(testHexDifficulty) : std::string();
+	m_dirtyRegions.trackText(DIFFICULTY_TEXT, getDifficultyTextArea(difficultyText), difficultyText);
+
+	m_dirtyRegions.redraw(SCREEN_SURFACE, [&](const HAPISPACE::RectangleI&) { Draw(); });
+}
 
+void OverworldUIWIndowTest::Draw()
+{
 	BattleMapBackground->Render(SCREEN_SURFACE);
 	EnemyTerritoryHexSheet->Render(SCREEN_SURFACE);
 
 	if (EnemyTerritoryHexSheet->GetFrameNumber() == 0)//only shows the difficulty number of the hex if the mouse isn't hovered over it
 	{
-		SCREEN_SURFACE->DrawText(HAPISPACE::VectorI(EnemyTerritoryHexSheet->GetTransformComp().GetPosition().x + EnemyTerritoryHexSheet->GetCurrentFrame().rect.right / 2.5, EnemyTerritoryHexSheet->GetTransformComp().GetPosition().y + EnemyTerritoryHexSheet->GetCurrentFrame().rect.bottom / 4), difficultyColour, std::to_string(testHexDifficulty), 90);
+		SCREEN_SURFACE->DrawText(getDifficultyTextPosition(), difficultyColour, std::to_string(testHexDifficulty), DIFFICULTY_TEXT_SIZE);
 	}
 
 	if (testPrebattleWindow)
@@ -91,6 +111,18 @@ void OverworldUIWIndowTest::Update()
 	//render current ship sprite 1200,300
 }
 
+HAPISPACE::VectorI OverworldUIWIndowTest::getDifficultyTextPosition() const
+{
+	return HAPISPACE::VectorI(EnemyTerritoryHexSheet->GetTransformComp().GetPosition().x + EnemyTerritoryHexSheet->GetCurrentFrame().rect.right / 2.5, EnemyTerritoryHexSheet->GetTransformComp().GetPosition().y + EnemyTerritoryHexSheet->GetCurrentFrame().rect.bottom / 4);
+}
+
+HAPISPACE::RectangleI OverworldUIWIndowTest::getDifficultyTextArea(const std::string& text) const
+{
+	//Rough bounds of the text, generous since glyph sizes aren't known
+	const HAPISPACE::VectorI position = getDifficultyTextPosition();
+	return HAPISPACE::RectangleI(position.x, position.x + DIFFICULTY_TEXT_SIZE * (int)text.size(), position.y, position.y + DIFFICULTY_TEXT_SIZE * 3 / 2);
+}
+
 void OverworldUIWIndowTest::Run()
 {
 	while (HAPI_Sprites.Update())
@@ -109,6 +141,7 @@ void OverworldUIWIndowTest::OnMouseEvent(EMouseEvent mouseEvent, const HAPI_TMou
 			{
 				testPrebattleWindow = true;
 				UI.OpenWindow("testWindow");
+				m_dirtyRegions.addOverlay(PREBATTLE_WINDOW_AREA);
 			}
 		}
 		else if (testPrebattleWindow)
@@ -117,12 +150,16 @@ void OverworldUIWIndowTest::OnMouseEvent(EMouseEvent mouseEvent, const HAPI_TMou
 			{
 				BattleSystem world;
 				UI.CloseWindow("testWindow");
+				m_dirtyRegions.removeOverlay(PREBATTLE_WINDOW_AREA);
 				world.run();
+				//The battle drew over the whole screen
+				m_dirtyRegions.markAllDirty();
 			}
 			else if (BackButton->GetSpritesheet()->GetFrameRect(0).Translated(BackButton->GetTransformComp().GetPosition()).Contains(HAPISPACE::RectangleI(mouseData.x, mouseData.x, mouseData.y, mouseData.y)))
 			{
 				testPrebattleWindow = false;
 				UI.CloseWindow("testWindow");
+				m_dirtyRegions.removeOverlay(PREBATTLE_WINDOW_AREA);
 			}
 		}
 	}
@@ -6,6 +6,7 @@ using namespace HAPI_UI_SPACE;
 #include <string>
 #include "Entity.h"
 #include "BattleSystem.h"
+#include "DirtyRegionTracker.h"
 class OverworldUI
 {
 public:
@@ -19,12 +20,17 @@ private:
 	RectangleI m_screenRect;
 	Transform m_rectTransform;
 	ColliderGroup m_rectCollider;
+	//Only the parts of the screen that changed are drawn again
+	DirtyRegionTracker m_dirtyRegions;
 
 	std::vector<Entity> m_entityVector;
 	std::vector<Entity> m_SelectedEntities;
 
 	std::shared_ptr<Sprite> sprite = HAPI_Sprites.LoadSprite("Data\\thing.png");
 
+	void Draw();
+	HAPISPACE::VectorI getDifficultyTextPosition() const;
+	HAPISPACE::RectangleI getDifficultyTextArea(const std::string& text) const;
 public:
 	bool Initialise();
 	void Update();
@@ -45,7 +51,7 @@ public:
 	int CameraPositionY = 0;
 	VectorF pendingCameraMovement{ 0 };
 
-	OverworldUIWIndowTest(RectangleI screenRect) : m_screenRect(screenRect), m_rectCollider({ 0,300,0,40 }) {}
+	OverworldUIWIndowTest(RectangleI screenRect) : m_screenRect(screenRect), m_rectCollider({ 0,300,0,40 }), m_dirtyRegions(screenRect) {}
 	float playerFleetPower = 3.2;
 	int testHexDifficulty = 1.7;//this needs to be changed back to a float once ive got it displaying the string to 1 decimal place
 	int hard = 2;//how many difficulty levels above the players power a level needs to be to be considered hard
@@ -0,0 +1,114 @@
+#include "PathCache.h"
+#include <algorithm>
+
+PathCacheStats::PathCacheStats() :
+	m_hits(0),
+	m_misses(0),
+	m_evictions(0),
+	m_invalidations(0)
+{
+}
+
+PathCache::PathCache(size_t capacity) :
+	m_capacity(std::max(size_t(1), capacity)),
+	m_entries(),
+	m_order(),
+	m_tileEntries(),
+	m_dimensions(0, 0),
+	m_stats()
+{
+}
+
+const std::vector<std::pair<int, int>>* PathCache::find(const PathCacheKey& key)
+{
+	auto it = m_entries.find(key);
+	if (it == m_entries.end())
+	{
+		m_stats.m_misses++;
+		return nullptr;
+	}
+
+	m_stats.m_hits++;
+	m_order.splice(m_order.begin(), m_order, it->second.m_order);
+	return &it->second.m_path;
+}
+
+void PathCache::insert(const PathCacheKey& key, const std::vector<std::pair<int, int>>& path, std::pair<int, int> mapDimensions)
+{
+	if (mapDimensions != m_dimensions)
+	{
+		clear();
+		m_dimensions = mapDimensions;
+	}
+
+	if (m_entries.find(key) != m_entries.end())
+		erase(key);
+
+	while (m_entries.size() >= m_capacity)
+	{
+		erase(m_order.back());
+		m_stats.m_evictions++;
+	}
+
+	m_order.push_front(key);
+	Entry& entry = m_entries[key];
+	entry.m_path = path;
+	entry.m_order = m_order.begin();
+	for (const std::pair<int, int>& tile : path)
+		m_tileEntries[getTileKey(tile)].push_back(key);
+}
+
+void PathCache::erase(const PathCacheKey& key)
+{
+	auto it = m_entries.find(key);
+	if (it == m_entries.end())
+		return;
+
+	for (const std::pair<int, int>& tile : it->second.m_path)
+	{
+		auto tileEntries = m_tileEntries.find(getTileKey(tile));
+		if (tileEntries == m_tileEntries.end())
+			continue;
+		std::vector<PathCacheKey>& keys = tileEntries->second;
+		keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+		if (keys.empty())
+			m_tileEntries.erase(tileEntries);
+	}
+	m_order.erase(it->second.m_order);
+	m_entries.erase(it);
+}
+
+void PathCache::onTileChanged(std::pair<int, int> coord, eTileChange change)
+{
+	auto tileEntries = m_tileEntries.find(getTileKey(coord));
+	if (tileEntries == m_tileEntries.end())
+		return;
+
+	//Copied since erase edits the tile lists
+	const std::vector<PathCacheKey> keys = tileEntries->second;
+	for (const PathCacheKey& key : keys)
+	{
+		//Paths that ignore ships don't care who is sitting on the tile
+		if (change == eOccupancyChange && key.m_policy == eIgnoreShips)
+			continue;
+		erase(key);
+		m_stats.m_invalidations++;
+	}
+}
+
+void PathCache::clear()
+{
+	m_entries.clear();
+	m_order.clear();
+	m_tileEntries.clear();
+}
+
+void PathCache::setCapacity(size_t capacity)
+{
+	m_capacity = std::max(size_t(1), capacity);
+	while (m_entries.size() > m_capacity)
+	{
+		erase(m_order.back());
+		m_stats.m_evictions++;
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "PathGrid.h"
+#include "MapListener.h"
+
+struct PathCacheKey
+{
+	std::pair<int, int> m_src;
+	std::pair<int, int> m_dest;
+	ePathPolicy m_policy;
+
+	bool operator==(const PathCacheKey& other) const
+	{
+		return m_src == other.m_src && m_dest == other.m_dest && m_policy == other.m_policy;
+	}
+};
+
+struct PathCacheKeyHash
+{
+	std::size_t operator()(const PathCacheKey& key) const
+	{
+		std::size_t hash = static_cast<std::size_t>(key.m_src.first) * 73856093u;
+		hash ^= static_cast<std::size_t>(key.m_src.second) * 19349663u;
+		hash ^= static_cast<std::size_t>(key.m_dest.first) * 83492791u;
+		hash ^= static_cast<std::size_t>(key.m_dest.second) * 2654435761u;
+		return hash ^ static_cast<std::size_t>(key.m_policy);
+	}
+};
+
+struct PathCacheStats
+{
+	unsigned int m_hits;
+	unsigned int m_misses;
+	//Dropped to make room for newer paths
+	unsigned int m_evictions;
+	//Dropped because a tile on the path changed
+	unsigned int m_invalidations;
+
+	PathCacheStats();
+	float getHitRate() const { return (m_hits + m_misses) == 0 ? 0.0f : (float)m_hits / (m_hits + m_misses); }
+};
+
+//Least recently used store of paths keyed by start, goal and policy.
+//An entry is only dropped when a tile along it changes in a way its policy cares about, or to make room.
+class PathCache
+{
+private:
+	struct Entry
+	{
+		std::vector<std::pair<int, int>> m_path;
+		std::list<PathCacheKey>::iterator m_order;
+	};
+
+	std::size_t m_capacity;
+	std::unordered_map<PathCacheKey, Entry, PathCacheKeyHash> m_entries;
+	//Most recently used at the front
+	std::list<PathCacheKey> m_order;
+	//Which cached paths pass over each tile
+	std::unordered_map<int, std::vector<PathCacheKey>> m_tileEntries;
+	std::pair<int, int> m_dimensions;
+	PathCacheStats m_stats;
+
+	int getTileKey(std::pair<int, int> coord) const { return coord.first + coord.second * m_dimensions.first; }
+	void erase(const PathCacheKey& key);
+public:
+	PathCache(std::size_t capacity = 256);
+
+	//Returns nullptr on a miss
+	const std::vector<std::pair<int, int>>* find(const PathCacheKey& key);
+	void insert(const PathCacheKey& key, const std::vector<std::pair<int, int>>& path, std::pair<int, int> mapDimensions);
+	void onTileChanged(std::pair<int, int> coord, eTileChange change);
+	void clear();
+
+	std::size_t getSize() const { return m_entries.size(); }
+	std::size_t getCapacity() const { return m_capacity; }
+	void setCapacity(std::size_t capacity);
+	const PathCacheStats& getStats() const { return m_stats; }
+	void resetStats() { m_stats = PathCacheStats(); }
+};
@@ -0,0 +1,75 @@
+#include "PathGrid.h"
+#include <algorithm>
+#include <stdlib.h>
+
+std::pair<int, int> PathGrid::getAdjacentCoordinate(std::pair<int, int> coord, int direction)
+{
+	//Odd columns sit half a tile higher than even columns
+	static const int oddOffsets[6][2] = { { 0, -1 }, { 1, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 }, { -1, -1 } };
+	static const int evenOffsets[6][2] = { { 0, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 } };
+
+	const int (&offset)[2] = (coord.first & 1) ? oddOffsets[direction] : evenOffsets[direction];
+	return std::pair<int, int>(coord.first + offset[0], coord.second + offset[1]);
+}
+
+int PathGrid::getDistance(std::pair<int, int> a, std::pair<int, int> b)
+{
+	//Same conversion as Map::offsetToCube
+	const int aY = -a.first - (a.second - (a.first + (a.first & 1)) / 2);
+	const int bY = -b.first - (b.second - (b.first + (b.first & 1)) / 2);
+	const int x = abs(a.first - b.first);
+	const int y = abs(aY - bY);
+	const int z = abs(a.first + aY - b.first - bY);
+	return std::max(x, std::max(y, z));
+}
+
+bool PathGrid::inBounds(std::pair<int, int> coord) const
+{
+	return coord.first >= 0 && coord.first < m_dimensions.first &&
+		coord.second >= 0 && coord.second < m_dimensions.second;
+}
+
+std::pair<int, int> PathGrid::getCoordinate(int index) const
+{
+	return std::pair<int, int>(index % m_dimensions.first, index / m_dimensions.first);
+}
+
+int PathGrid::getAdjacentIndex(int index, int direction) const
+{
+	const std::pair<int, int> adjacent = getAdjacentCoordinate(getCoordinate(index), direction);
+	if (!inBounds(adjacent))
+		return -1;
+	return getIndex(adjacent);
+}
+
+std::vector<bool> PathGrid::getTilesOfType(eTileType type) const
+{
+	std::vector<bool> tiles(getSize(), false);
+	for (int index = 0; index < getSize(); index++)
+		tiles[index] = getType(index) == type;
+	return tiles;
+}
+
+std::vector<bool> PathGrid::getTilesAdjacentTo(const std::vector<std::pair<int, int>>& coords) const
+{
+	std::vector<bool> tiles(getSize(), false);
+	for (const std::pair<int, int>& coord : coords)
+	{
+		if (!inBounds(coord))
+			continue;
+		for (int direction = eNorth; direction <= eNorthWest; direction++)
+		{
+			const int adjacent = getAdjacentIndex(getIndex(coord), direction);
+			if (adjacent != -1)
+				tiles[adjacent] = true;
+		}
+	}
+	return tiles;
+}
+
+PathGrid::PathGrid(std::pair<int, int> dimensions, eTileType fill) :
+	m_dimensions(dimensions),
+	m_type(dimensions.first * dimensions.second, static_cast<unsigned char>(fill)),
+	m_occupied(dimensions.first * dimensions.second, 0)
+{
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "Global.h"
+
+//How a search treats ships sitting on tiles
+enum ePathPolicy
+{
+	eAvoidShips,	//Occupied tiles are blocked, a route that can be sailed right now
+	eIgnoreShips	//Terrain only, for planning ahead when the way may have cleared
+};
+
+//Flat copy of the terrain and occupancy of the map used by the pathfinding searches.
+//Map keeps it in sync so searches never have to go through the tile sprites.
+class PathGrid
+{
+private:
+	std::pair<int, int> m_dimensions;
+	std::vector<unsigned char> m_type;
+	std::vector<unsigned char> m_occupied;
+
+public:
+	//Cheapest cost of entering any tile, used to bound how far a search can spread
+	static constexpr float MIN_MOVEMENT_COST = 1.0f;
+
+	//Same six direction adjacency as Map::getAdjacentTiles, indexed by eDirection
+	static std::pair<int, int> getAdjacentCoordinate(std::pair<int, int> coord, int direction);
+	//Number of hex steps between two tiles in offset coordinates
+	static int getDistance(std::pair<int, int> a, std::pair<int, int> b);
+
+	std::pair<int, int> getDimensions() const { return m_dimensions; }
+	int getSize() const { return m_dimensions.first * m_dimensions.second; }
+
+	bool inBounds(std::pair<int, int> coord) const;
+	int getIndex(std::pair<int, int> coord) const { return coord.first + coord.second * m_dimensions.first; }
+	std::pair<int, int> getCoordinate(int index) const;
+	//Returns the index of the neighbour in the given direction, -1 if it is off the map
+	int getAdjacentIndex(int index, int direction) const;
+
+	eTileType getType(int index) const { return static_cast<eTileType>(m_type[index]); }
+	void setType(int index, eTileType type) { m_type[index] = static_cast<unsigned char>(type); }
+	bool isOccupied(int index) const { return m_occupied[index] != 0; }
+	void setOccupied(int index, bool occupied) { m_occupied[index] = occupied ? 1 : 0; }
+
+	//Ships only sail on open water and into ports, every other tile is land. The sea lane graph uses the same rule.
+	static bool isNavigableType(eTileType type)
+	{
+		return type == eSea || type == eOcean || type == eLeftPort || type == eRightPort;
+	}
+	//Cost of sailing onto a tile of the given type, never less than MIN_MOVEMENT_COST. Land is never entered.
+	static float getTypeCost(eTileType type)
+	{
+		switch (type)
+		{
+		case eLeftPort:
+		case eRightPort:
+			return 2.0f;
+		default:
+			return MIN_MOVEMENT_COST;
+		}
+	}
+
+	//Terrain allows movement, ignoring any ships on it
+	bool isNavigable(int index) const { return isNavigableType(getType(index)); }
+	bool isPassable(int index) const { return isNavigable(index) && !isOccupied(index); }
+	bool canEnter(int index, ePathPolicy policy) const { return policy == eIgnoreShips ? isNavigable(index) : isPassable(index); }
+	float getMovementCost(int index) const { return getTypeCost(getType(index)); }
+
+	//Goal sets for the nearest goal searches, one flag per tile
+	std::vector<bool> getTilesOfType(eTileType type) const;
+	std::vector<bool> getTilesAdjacentTo(const std::vector<std::pair<int, int>>& coords) const;
+
+	PathGrid(std::pair<int, int> dimensions, eTileType fill = eOcean);
+};
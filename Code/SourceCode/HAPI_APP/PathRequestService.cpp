@@ -0,0 +1,164 @@
+#include "PathRequestService.h"
+#include "Pathfinding.h"
+#include <algorithm>
+#include <iterator>
+
+PathRequest::PathRequest(std::pair<int, int> src, std::pair<int, int> dest, ePathPolicy policy, int priority) :
+	m_src(src),
+	m_dest(dest),
+	m_policy(policy),
+	m_priority(priority)
+{
+}
+
+PathRequestService::PathRequestService(unsigned int threadCount) :
+	m_nextRequestId(0),
+	m_stopping(false)
+{
+	if (threadCount == 0)
+	{
+		const unsigned int hardware = std::thread::hardware_concurrency();
+		threadCount = hardware > 1 ? hardware - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+		m_workers.emplace_back(&PathRequestService::workerLoop, this);
+}
+
+PathRequestService::~PathRequestService()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_workAvailable.notify_all();
+	for (std::thread& worker : m_workers)
+		worker.join();
+}
+
+void PathRequestService::workerLoop()
+{
+	//Each worker keeps its own search workspace so searches never share state
+	Pathfinding pathfinding;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		m_workAvailable.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+		if (m_stopping)
+			return;
+
+		auto next = m_pending.begin();
+		const int requestId = next->second;
+		m_pending.erase(next);
+		auto jobIt = m_jobs.find(requestId);
+		Job job = std::move(jobIt->second);
+		m_jobs.erase(jobIt);
+		m_running.insert(requestId);
+
+		lock.unlock();
+		PathResult result;
+		result.m_requestId = requestId;
+		result.m_request = job.m_request;
+		result.m_path = pathfinding.findPath(*job.m_grid, job.m_request.m_src, job.m_request.m_dest, job.m_request.m_policy);
+		lock.lock();
+
+		m_running.erase(requestId);
+		if (m_cancelled.erase(requestId) == 0)
+			m_completed.push_back(std::move(result));
+		if (m_pending.empty() && m_running.empty())
+			m_batchDone.notify_all();
+	}
+}
+
+std::vector<int> PathRequestService::submitBatch(const PathGrid& grid, const std::vector<PathRequest>& requests)
+{
+	std::vector<int> requestIds;
+	if (requests.empty())
+		return requestIds;
+
+	//Copied outside the lock, the whole batch shares one snapshot
+	std::shared_ptr<const PathGrid> snapshot = std::make_shared<const PathGrid>(grid);
+	requestIds.reserve(requests.size());
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const PathRequest& request : requests)
+		{
+			const int requestId = m_nextRequestId++;
+			m_jobs[requestId] = Job{ requestId, request, snapshot };
+			m_pending.insert(pendingKey(-request.m_priority, requestId));
+			requestIds.push_back(requestId);
+		}
+	}
+	m_workAvailable.notify_all();
+	return requestIds;
+}
+
+int PathRequestService::submit(const PathGrid& grid, const PathRequest& request)
+{
+	return submitBatch(grid, std::vector<PathRequest>(1, request)).front();
+}
+
+bool PathRequestService::cancel(int requestId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto jobIt = m_jobs.find(requestId);
+	if (jobIt != m_jobs.end())
+	{
+		m_pending.erase(pendingKey(-jobIt->second.m_request.m_priority, requestId));
+		m_jobs.erase(jobIt);
+		if (m_pending.empty() && m_running.empty())
+			m_batchDone.notify_all();
+		return true;
+	}
+	if (m_running.find(requestId) != m_running.end())
+	{
+		m_cancelled.insert(requestId);
+		return true;
+	}
+	return false;
+}
+
+void PathRequestService::cancelAll()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending.clear();
+	m_jobs.clear();
+	m_cancelled.insert(m_running.begin(), m_running.end());
+	if (m_running.empty())
+		m_batchDone.notify_all();
+}
+
+bool PathRequestService::setPriority(int requestId, int priority)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto jobIt = m_jobs.find(requestId);
+	if (jobIt == m_jobs.end())
+		return false;
+
+	m_pending.erase(pendingKey(-jobIt->second.m_request.m_priority, requestId));
+	jobIt->second.m_request.m_priority = priority;
+	m_pending.insert(pendingKey(-priority, requestId));
+	return true;
+}
+
+size_t PathRequestService::pollResults(std::vector<PathResult>& results)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const size_t count = m_completed.size();
+	std::move(m_completed.begin(), m_completed.end(), std::back_inserter(results));
+	m_completed.clear();
+	return count;
+}
+
+void PathRequestService::waitForAll()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_batchDone.wait(lock, [this] { return m_pending.empty() && m_running.empty(); });
+}
+
+size_t PathRequestService::getPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pending.size() + m_running.size();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "PathGrid.h"
+
+struct PathRequest
+{
+	std::pair<int, int> m_src;
+	std::pair<int, int> m_dest;
+	ePathPolicy m_policy;
+	//Higher runs first, requests of equal priority run in the order they were submitted
+	int m_priority;
+
+	PathRequest(std::pair<int, int> src = std::pair<int, int>(0, 0), std::pair<int, int> dest = std::pair<int, int>(0, 0),
+		ePathPolicy policy = eAvoidShips, int priority = 0);
+};
+
+struct PathResult
+{
+	int m_requestId;
+	PathRequest m_request;
+	//From dest back to src like Pathfinding::findPath, empty if there is no route
+	std::vector<std::pair<int, int>> m_path;
+};
+
+//Runs path searches on worker threads so AI turns don't stall the frame.
+//Each batch is searched against its own copy of the grid, so the map can keep changing while it runs.
+//Finished results wait in a completion queue until the frame loop collects them with pollResults.
+class PathRequestService
+{
+private:
+	struct Job
+	{
+		int m_requestId;
+		PathRequest m_request;
+		std::shared_ptr<const PathGrid> m_grid;
+	};
+	//Orders pending jobs by priority, highest first, then by request id
+	typedef std::pair<int, int> pendingKey;
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_batchDone;
+	std::set<pendingKey> m_pending;
+	std::unordered_map<int, Job> m_jobs;
+	//Requests being searched right now, cancelling one drops its result when it finishes
+	std::set<int> m_running;
+	std::set<int> m_cancelled;
+	std::deque<PathResult> m_completed;
+	int m_nextRequestId;
+	bool m_stopping;
+
+	void workerLoop();
+public:
+	//0 threads uses one less than the hardware has, leaving a core for the frame loop
+	PathRequestService(unsigned int threadCount = 0);
+	~PathRequestService();
+	PathRequestService(const PathRequestService&) = delete;
+	PathRequestService& operator=(const PathRequestService&) = delete;
+
+	//Queues the requests against a snapshot of grid, returns their ids in the same order
+	std::vector<int> submitBatch(const PathGrid& grid, const std::vector<PathRequest>& requests);
+	int submit(const PathGrid& grid, const PathRequest& request);
+	//A request that hasn't finished never reaches the completion queue. Returns false if it already finished.
+	bool cancel(int requestId);
+	void cancelAll();
+	//Only affects requests still waiting for a worker, returns false otherwise
+	bool setPriority(int requestId, int priority);
+
+	//Moves every finished result into results, returns how many there were
+	size_t pollResults(std::vector<PathResult>& results);
+	//Blocks until nothing is pending or running, for turn ends that need every path
+	void waitForAll();
+	size_t getPendingCount();
+	size_t getThreadCount() const { return m_workers.size(); }
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <functional>
+
+//Debug builds count what the searches do, release builds compile the counting out.
+//Define PATH_INSTRUMENTATION to keep it in a release build or PATH_NO_INSTRUMENTATION to drop it from a debug one.
+#if !defined(NDEBUG) && !defined(PATH_NO_INSTRUMENTATION) && !defined(PATH_INSTRUMENTATION)
+#define PATH_INSTRUMENTATION
+#endif
+
+#ifdef PATH_INSTRUMENTATION
+#define PATH_STAT(...) __VA_ARGS__
+#else
+#define PATH_STAT(...)
+#endif
+
+//Totals over every search since the stats were last reset
+struct PathSearchStats
+{
+	unsigned long long m_searches;
+	unsigned long long m_failures;
+	unsigned long long m_expansions;
+	unsigned long long m_pushes;
+	unsigned long long m_pops;
+	//Pops of entries left behind when a tile was pushed again more cheaply
+	unsigned long long m_stalePops;
+	unsigned long long m_workspaceReuses;
+	unsigned long long m_workspaceAllocations;
+	long long m_wallTimeNanoseconds;
+
+	PathSearchStats() :
+		m_searches(0),
+		m_failures(0),
+		m_expansions(0),
+		m_pushes(0),
+		m_pops(0),
+		m_stalePops(0),
+		m_workspaceReuses(0),
+		m_workspaceAllocations(0),
+		m_wallTimeNanoseconds(0)
+	{
+	}
+};
+
+enum ePathTraceEvent
+{
+	eTraceSearchStarted,
+	eTraceTileExpanded,
+	eTraceSearchFound,
+	eTraceSearchFailed
+};
+
+//tile is a PathGrid index (-1 if the search failed before it had one), cost is the cost of reaching it
+typedef std::function<void(ePathTraceEvent event, int tile, float cost)> PathTraceCallback;
+
+//Adds the time between construction and destruction to the stats
+class PathSearchTimer
+{
+private:
+	PathSearchStats& m_stats;
+	std::chrono::steady_clock::time_point m_start;
+public:
+	PathSearchTimer(PathSearchStats& stats) : m_stats(stats), m_start(std::chrono::steady_clock::now()) {}
+	~PathSearchTimer() { m_stats.m_wallTimeNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count(); }
+};
@@ -1,226 +1,499 @@
 #include "Pathfinding.h"
 #include "Map.h"
-
-
-Pathfinding::Pathfinding()
+#include "Entity.h"
+#include <algorithm>
+#include <limits.h>
+#include <functional>
+#include <queue>
+
+
+Pathfinding::Pathfinding() :
+	m_map(nullptr),
+	m_cachedGrid(nullptr),
+	m_pathCache(),
+	m_lastExpansions(0),
+	m_stats(),
+	m_traceCallback(),
+	m_searchStamp(0)
 {
 }
 
-Pathfinding::~Pathfinding()
+Pathfinding::Pathfinding(Map& map) :
+	m_map(&map),
+	m_cachedGrid(&map.getPathGrid()),
+	m_pathCache(),
+	m_lastExpansions(0),
+	m_stats(),
+	m_traceCallback(),
+	m_searchStamp(0)
 {
+	m_map->addListener(this);
 }
 
-bool Pathfinding::isValid(int row, int col)const
+Pathfinding::Pathfinding(const PathGrid& grid) :
+	m_map(nullptr),
+	m_cachedGrid(&grid),
+	m_pathCache(),
+	m_lastExpansions(0),
+	m_stats(),
+	m_traceCallback(),
+	m_searchStamp(0)
 {
-	//returns true if the row and col are in range
-	return (row >= 1) && (row < m_size) &&
-		(col >= 1) && (col < m_size);
 }
 
-bool Pathfinding::isUnBlocked(Map &map, Pair coord)const
+Pathfinding::~Pathfinding()
 {
-	
-	if (map.getTile(coord) != nullptr)
-		return true;
-	else
-		return false;
+	if (m_map)
+		m_map->removeListener(this);
 }
 
-
-bool Pathfinding::isDestination(int row, int col, Pair dest)const
+void Pathfinding::aStarSearch(Map &map, Pair src, Pair dest)
 {
-	if (row == dest.first && col == dest.second)
-		return true;
-	else
-		return false;
+	//Kept for old callers, the search itself is findPath so it no longer copies the map or its sprites.
+	//A failed search shows up in getStats or the trace callback.
+	m_path = findPath(map.getPathGrid(), src, dest);
 }
 
-double Pathfinding::calculateHeuristicValue(int row, int col, Pair dest)const
+void Pathfinding::recordFailure(int tile)
 {
-	//calculated using Euclidean Distance
-	return((double)sqrt((row - dest.first)*(row - dest.first) + (col - dest.second) * (col - dest.second)));
+	m_stats.m_failures++;
+	trace(eTraceSearchFailed, tile, 0.0f);
 }
 
-void Pathfinding::tracePath(const std::vector<std::vector<cell> >& cellDetails, Pair dest)
+void Pathfinding::prepareWorkspace(int size)
 {
-	int row = dest.first;
-	int col = dest.second;
-
-	//std::stack <Pair> path;
-
-	while (!(cellDetails[row][col].parent_i == row && cellDetails[row][col].parent_j == col))
+	if (static_cast<int>(m_searchStamps.size()) != size)
 	{
-		m_path.push_back(std::make_pair(row, col));
-		int tempRow = cellDetails[row][col].parent_i;
-		int tempCol = cellDetails[row][col].parent_j;
+		m_searchCost.assign(size, FLT_MAX);
+		m_searchParent.assign(size, -1);
+		m_searchStamps.assign(size, 0);
+		m_goalStamps.assign(size, 0);
+		m_searchStamp = 0;
+		PATH_STAT(m_stats.m_workspaceAllocations++);
+	}
+	else
+	{
+		PATH_STAT(m_stats.m_workspaceReuses++);
+	}
 
-		row = tempRow;
-		col = tempCol;
+	m_searchStamp++;
+	if (m_searchStamp == 0)
+	{
+		//Wrapped around, old stamps could match again
+		std::fill(m_searchStamps.begin(), m_searchStamps.end(), 0);
+		std::fill(m_goalStamps.begin(), m_goalStamps.end(), 0);
+		m_searchStamp = 1;
 	}
-	m_path.push_back(std::make_pair(row, col));
 }
 
-void Pathfinding::aStarSearch(Map &map, Pair src, Pair dest)
+std::vector<Pair> Pathfinding::findPath(const PathGrid& grid, Pair src, Pair dest, ePathPolicy policy, const ZoneOfControl* zoc)
 {
-	const std::vector<Tile> grid = *map.getMap();
-	m_size = grid.size()/2;
-	if (!isValid(dest.first, dest.second))
+	std::vector<Pair> path;
+	m_lastExpansions = 0;
+	PATH_STAT(PathSearchTimer timer(m_stats));
+	PATH_STAT(m_stats.m_searches++);
+	if (!grid.inBounds(src) || !grid.inBounds(dest))
 	{
-		std::cout << "Destination is invalid" << std::endl;
-		return;
+		PATH_STAT(recordFailure(-1));
+		return path;
 	}
+	if (zoc && zoc->getDimensions() != grid.getDimensions())
+		zoc = nullptr;
 
-	if (!isUnBlocked(map, src) || !isUnBlocked(map, dest))
+	const int srcIndex = grid.getIndex(src);
+	const int destIndex = grid.getIndex(dest);
+	PATH_STAT(trace(eTraceSearchStarted, srcIndex, 0.0f));
+	if (!grid.canEnter(destIndex, policy))
 	{
-		std::cout << "Source or Destination blocked" << std::endl;
-		return;
+		PATH_STAT(recordFailure(destIndex));
+		return path;
 	}
-
-	if (isDestination(src.first, src.second, dest))
+	if (srcIndex == destIndex)
 	{
-		std::cout << "Destination Already reached" << std::endl;
-		return;
+		PATH_STAT(trace(eTraceSearchFound, destIndex, 0.0f));
+		path.push_back(src);
+		return path;
 	}
 
-	//bool closedList[m_size][m_size];
-	std::vector < std::vector<bool>> closedList;
-	closedList.resize(m_size);
-	for (int i = 0; i < closedList.size(); i++)
-		closedList[i].resize(m_size);
-	
-	std::vector<std::vector<cell> > cellDetails;
-	cellDetails.resize(m_size);
-	for (int i = 0; i < cellDetails.size(); i++)
-		cellDetails[i].resize(m_size);
+	prepareWorkspace(grid.getSize());
+
+	//open list contains pair <f, tile index>, f = g + h
+	typedef std::pair<float, int> openEntry;
+	std::priority_queue<openEntry, std::vector<openEntry>, std::greater<openEntry>> openList;
 
-	int i, j;
+	m_searchCost[srcIndex] = 0.0f;
+	m_searchParent[srcIndex] = srcIndex;
+	m_searchStamps[srcIndex] = m_searchStamp;
+	openList.push(openEntry(PathGrid::getDistance(src, dest) * PathGrid::MIN_MOVEMENT_COST, srcIndex));
+	PATH_STAT(m_stats.m_pushes++);
 
-	for (i = 0; i < m_size; i++)
+	bool destFound = false;
+	while (!openList.empty())
 	{
-		for (j = 0; j < m_size; j++)
+		const openEntry p = openList.top();
+		openList.pop();
+		PATH_STAT(m_stats.m_pops++);
+
+		const float g = m_searchCost[p.second];
+		const Pair coord = grid.getCoordinate(p.second);
+		if (p.first > g + PathGrid::getDistance(coord, dest) * PathGrid::MIN_MOVEMENT_COST)
+		{
+			PATH_STAT(m_stats.m_stalePops++);
+			continue;
+		}
+		m_lastExpansions++;
+		PATH_STAT(m_stats.m_expansions++);
+		PATH_STAT(trace(eTraceTileExpanded, p.second, g));
+		if (p.second == destIndex)
+		{
+			destFound = true;
+			break;
+		}
+		if (zoc && p.second != srcIndex && zoc->stopsMovement(p.second))
+			continue;
+
+		for (int direction = eNorth; direction <= eNorthWest; direction++)
 		{
-			cellDetails[i][j].f = FLT_MAX;
-			cellDetails[i][j].g = FLT_MAX;
-			cellDetails[i][j].h = FLT_MAX;
-			cellDetails[i][j].parent_i = -1;
-			cellDetails[i][j].parent_j = -1;
+			const int adjacent = grid.getAdjacentIndex(p.second, direction);
+			if (adjacent == -1 || !grid.canEnter(adjacent, policy))
+				continue;
+
+			float sucG = g + grid.getMovementCost(adjacent);
+			if (zoc)
+				sucG += zoc->getExtraCost(adjacent);
+			if (sucG < getSearchCost(adjacent))
+			{
+				m_searchCost[adjacent] = sucG;
+				m_searchParent[adjacent] = p.second;
+				m_searchStamps[adjacent] = m_searchStamp;
+				const float sucH = PathGrid::getDistance(grid.getCoordinate(adjacent), dest) * PathGrid::MIN_MOVEMENT_COST;
+				openList.push(openEntry(sucG + sucH, adjacent));
+				PATH_STAT(m_stats.m_pushes++);
+			}
 		}
 	}
 
-	i = src.first, j = src.second;
-	cellDetails[i][j].f = 0.0;
-	cellDetails[i][j].g = 0.0;
-	cellDetails[i][j].h = 0.0;
-	cellDetails[i][j].parent_i = i;
-	cellDetails[i][j].parent_j = j;
+	if (!destFound)
+	{
+		PATH_STAT(recordFailure(destIndex));
+		return path;
+	}
+	PATH_STAT(trace(eTraceSearchFound, destIndex, m_searchCost[destIndex]));
+	return getSearchPath(grid, srcIndex, destIndex);
+}
 
-	//open list contains pair <f,<i,j>>
-	//f = h+g
-	//i and j are the rows and cols
-	std::set<pPair> openList;
-	openList.insert(std::make_pair(0.0, std::make_pair(i, j)));
+std::vector<Pair> Pathfinding::getSearchPath(const PathGrid& grid, int srcIndex, int destIndex) const
+{
+	std::vector<Pair> path;
+	for (int index = destIndex; index != srcIndex; index = m_searchParent[index])
+		path.push_back(grid.getCoordinate(index));
+	path.push_back(grid.getCoordinate(srcIndex));
+	return path;
+}
 
-	bool destFound = false;
+void Pathfinding::searchGoals(const PathGrid& grid, Pair src, const std::vector<bool>* goalMask, const std::vector<Pair>* heuristicGoals,
+	int k, ePathPolicy policy, std::vector<int>& found)
+{
+	//Checking the distance to every goal per tile only pays off for a handful of them
+	const size_t MAX_HEURISTIC_GOALS = 8;
+
+	found.clear();
+	m_lastExpansions = 0;
+	PATH_STAT(PathSearchTimer timer(m_stats));
+	PATH_STAT(m_stats.m_searches++);
+	if (!grid.inBounds(src) || k <= 0 || (goalMask && static_cast<int>(goalMask->size()) != grid.getSize()))
+	{
+		PATH_STAT(recordFailure(-1));
+		return;
+	}
+
+	prepareWorkspace(grid.getSize());
+	std::vector<Pair> targets;
+	if (heuristicGoals)
+	{
+		for (const Pair& goal : *heuristicGoals)
+		{
+			if (!grid.inBounds(goal))
+				continue;
+			m_goalStamps[grid.getIndex(goal)] = m_searchStamp;
+			targets.push_back(goal);
+		}
+		if (targets.size() > MAX_HEURISTIC_GOALS)
+			targets.clear();
+	}
+
+	auto isGoal = [&](int index) { return goalMask ? (*goalMask)[index] : m_goalStamps[index] == m_searchStamp; };
+	//Distance to the closest goal, never more than the real cost so the first goal settled is the nearest
+	auto getHeuristic = [&](int index)
+	{
+		if (targets.empty())
+			return 0.0f;
+		const Pair coord = grid.getCoordinate(index);
+		int nearest = INT_MAX;
+		for (const Pair& target : targets)
+			nearest = std::min(nearest, PathGrid::getDistance(coord, target));
+		return nearest * PathGrid::MIN_MOVEMENT_COST;
+	};
+
+	//open list contains pair <f, tile index>
+	typedef std::pair<float, int> openEntry;
+	std::priority_queue<openEntry, std::vector<openEntry>, std::greater<openEntry>> openList;
+
+	const int srcIndex = grid.getIndex(src);
+	m_searchCost[srcIndex] = 0.0f;
+	m_searchParent[srcIndex] = srcIndex;
+	m_searchStamps[srcIndex] = m_searchStamp;
+	openList.push(openEntry(getHeuristic(srcIndex), srcIndex));
+	PATH_STAT(m_stats.m_pushes++);
+	PATH_STAT(trace(eTraceSearchStarted, srcIndex, 0.0f));
 
 	while (!openList.empty())
 	{
-		pPair p = *openList.begin();
-		openList.erase(openList.begin());
+		const openEntry p = openList.top();
+		openList.pop();
+		PATH_STAT(m_stats.m_pops++);
 
-		i = p.second.first;
-		j = p.second.second;
-		closedList[i][j] = true;
-		if (isValid(i, j))
+		const float g = m_searchCost[p.second];
+		if (p.first > g + getHeuristic(p.second))
+		{
+			PATH_STAT(m_stats.m_stalePops++);
+			continue;
+		}
+		m_lastExpansions++;
+		PATH_STAT(m_stats.m_expansions++);
+		PATH_STAT(trace(eTraceTileExpanded, p.second, g));
+		if (isGoal(p.second))
 		{
-			std::vector<Tile*> adjacentCells = map.getAdjacentTiles(Pair(i, j));
+			found.push_back(p.second);
+			PATH_STAT(trace(eTraceSearchFound, p.second, g));
+			if (static_cast<int>(found.size()) == k)
+				return;
+		}
 
-			double sucG, sucH, sucF;
+		for (int direction = eNorth; direction <= eNorthWest; direction++)
+		{
+			const int adjacent = grid.getAdjacentIndex(p.second, direction);
+			if (adjacent == -1 || !grid.canEnter(adjacent, policy))
+				continue;
 
-			for (int cellIndex = 0; cellIndex < adjacentCells.size(); cellIndex++)
+			const float sucG = g + grid.getMovementCost(adjacent);
+			if (sucG < getSearchCost(adjacent))
 			{
-				int x = adjacentCells[cellIndex]->m_tileCoordinate.first;
-				int y = adjacentCells[cellIndex]->m_tileCoordinate.second;
-				if (isValid(x, y))
-				{
-					if (isDestination(x, y, dest))
-					{
-						cellDetails[x][y].parent_i = i;
-						cellDetails[x][y].parent_j = j;
-						tracePath(cellDetails, dest);
-						destFound = true;
-						return;
-					}
-					else if (!closedList[x][y] && isUnBlocked(map, Pair(x, y)))
-					{
-						sucG = cellDetails[i][j].g + 1.0;
-						sucH = calculateHeuristicValue(x, y, dest);
-						sucF = sucG + sucH;
-
-						if (cellDetails[x][y].f == FLT_MAX || cellDetails[x][y].f > sucF)
-						{
-							openList.insert(std::make_pair(sucF, std::make_pair(x, y)));
-							cellDetails[x][y].f = sucF;
-							cellDetails[x][y].g = sucG;
-							cellDetails[x][y].h = sucH;
-							cellDetails[x][y].parent_i = i;
-							cellDetails[x][y].parent_j = j;
-						}
-					}
-				}
+				m_searchCost[adjacent] = sucG;
+				m_searchParent[adjacent] = p.second;
+				m_searchStamps[adjacent] = m_searchStamp;
+				openList.push(openEntry(sucG + getHeuristic(adjacent), adjacent));
+				PATH_STAT(m_stats.m_pushes++);
 			}
 		}
 	}
-	if (!destFound)
-		std::cout << "Failed to find destination" << std::endl;
+
+	PATH_STAT(if (found.empty()) recordFailure(-1));
+}
+
+std::vector<Pair> Pathfinding::findNearestGoal(const PathGrid& grid, Pair src, const std::vector<Pair>& goals, ePathPolicy policy)
+{
+	std::vector<int> found;
+	searchGoals(grid, src, nullptr, &goals, 1, policy, found);
+	if (found.empty())
+		return std::vector<Pair>();
+	return getSearchPath(grid, grid.getIndex(src), found.front());
+}
+
+std::vector<Pair> Pathfinding::findNearestGoal(const PathGrid& grid, Pair src, const std::vector<bool>& goalMask, ePathPolicy policy)
+{
+	std::vector<int> found;
+	searchGoals(grid, src, &goalMask, nullptr, 1, policy, found);
+	if (found.empty())
+		return std::vector<Pair>();
+	return getSearchPath(grid, grid.getIndex(src), found.front());
 }
 
-void Pathfinding::findAvailableTiles(Pair src, Map &map, int depth)
+std::vector<std::vector<Pair>> Pathfinding::findNearestGoals(const PathGrid& grid, Pair src, const std::vector<Pair>& goals, int k, ePathPolicy policy)
 {
-	const std::vector<Tile> grid = *map.getMap();
-	m_size = grid.size()/2;
-	int currentDepth = 0;
-	int i;
-	int j;
-	std::set<Pair> openList;
-	openList.insert(src);
+	std::vector<int> found;
+	searchGoals(grid, src, nullptr, &goals, k, policy, found);
+	std::vector<std::vector<Pair>> paths;
+	for (int goal : found)
+		paths.push_back(getSearchPath(grid, grid.getIndex(src), goal));
+	return paths;
+}
 
-	std::vector < std::vector<bool>> closedList;
-	closedList.resize(m_size);
-	for (int i = 0; i < closedList.size(); i++)
-		closedList[i].resize(m_size);
+std::vector<std::vector<Pair>> Pathfinding::findNearestGoals(const PathGrid& grid, Pair src, const std::vector<bool>& goalMask, int k, ePathPolicy policy)
+{
+	std::vector<int> found;
+	searchGoals(grid, src, &goalMask, nullptr, k, policy, found);
+	std::vector<std::vector<Pair>> paths;
+	for (int goal : found)
+		paths.push_back(getSearchPath(grid, grid.getIndex(src), goal));
+	return paths;
+}
 
-	while (currentDepth < depth)
+std::vector<Pair> Pathfinding::findCachedPath(const PathGrid& grid, Pair src, Pair dest, ePathPolicy policy)
+{
+	//Nothing would drop a path cached from a grid this isn't hearing changes to
+	if (&grid != m_cachedGrid)
+		return findPath(grid, src, dest, policy);
+
+	const PathCacheKey key{ src, dest, policy };
+	const std::vector<Pair>* cached = m_pathCache.find(key);
+	if (cached)
+		return *cached;
+
+	std::vector<Pair> path = findPath(grid, src, dest, policy);
+	//Failed searches aren't cached, there is no tile on them to invalidate them by
+	if (!path.empty())
+		m_pathCache.insert(key, path, grid.getDimensions());
+	return path;
+}
+
+void Pathfinding::onTileChanged(std::pair<int, int> coord, eTileChange change)
+{
+	m_pathCache.onTileChanged(coord, change);
+}
+
+ReachabilityMap Pathfinding::findAvailableTiles(const PathGrid& grid, Pair src, float movementPoints, const ZoneOfControl* zoc)
+{
+	ReachabilityMap result(grid, src, movementPoints);
+	m_range.clear();
+	m_lastExpansions = 0;
+	PATH_STAT(PathSearchTimer timer(m_stats));
+	PATH_STAT(m_stats.m_searches++);
+	if (!grid.inBounds(src) || movementPoints < 0.0f)
 	{
-		Pair p = *openList.begin();
-		openList.erase(openList.begin());
+		PATH_STAT(recordFailure(-1));
+		return result;
+	}
+	PATH_STAT(trace(eTraceSearchStarted, grid.getIndex(src), 0.0f));
+	if (zoc && zoc->getDimensions() != grid.getDimensions())
+		zoc = nullptr;
 
-		i = p.first;
-		j = p.second;
-		closedList[i][j] = true;
+	//open list contains pair <cost, local index>, entries left behind by a cheaper push are skipped when popped
+	typedef std::pair<float, int> openEntry;
+	std::priority_queue<openEntry, std::vector<openEntry>, std::greater<openEntry>> openList;
 
-		if (isValid(i, j))
+	const int srcLocal = result.getLocalIndex(src);
+	result.m_cost[srcLocal] = 0.0f;
+	result.m_parent[srcLocal] = srcLocal;
+	openList.push(openEntry(0.0f, srcLocal));
+	PATH_STAT(m_stats.m_pushes++);
+
+	while (!openList.empty())
+	{
+		const openEntry p = openList.top();
+		openList.pop();
+		PATH_STAT(m_stats.m_pops++);
+		if (p.first > result.m_cost[p.second])
 		{
-			std::vector<Tile*> adjacentCells = map.getAdjacentTiles(Pair(i, j));
+			PATH_STAT(m_stats.m_stalePops++);
+			continue;
+		}
+		m_lastExpansions++;
+		PATH_STAT(m_stats.m_expansions++);
+
+		const Pair coord = result.getLocalCoordinate(p.second);
+		result.m_tiles.push_back(coord);
+		if (p.second != srcLocal)
+			m_range.push_back(coord);
+
+		const int gridIndex = grid.getIndex(coord);
+		PATH_STAT(trace(eTraceTileExpanded, gridIndex, p.first));
+		//Ships can always leave the tile they start on
+		if (zoc && p.second != srcLocal && zoc->stopsMovement(gridIndex))
+			continue;
 
-			for (int cellIndex = 0; cellIndex < adjacentCells.size(); cellIndex++)
+		for (int direction = eNorth; direction <= eNorthWest; direction++)
+		{
+			const int adjacent = grid.getAdjacentIndex(gridIndex, direction);
+			if (adjacent == -1 || !grid.isPassable(adjacent))
+				continue;
+
+			float sucCost = p.first + grid.getMovementCost(adjacent);
+			if (zoc)
+				sucCost += zoc->getExtraCost(adjacent);
+			if (sucCost > movementPoints)
+				continue;
+
+			const int adjacentLocal = result.getLocalIndex(grid.getCoordinate(adjacent));
+			if (adjacentLocal != -1 && sucCost < result.m_cost[adjacentLocal])
 			{
-				if (adjacentCells[cellIndex] != nullptr)
-				{
-					int x = adjacentCells[cellIndex]->m_tileCoordinate.first;
-					int y = adjacentCells[cellIndex]->m_tileCoordinate.second;
-
-					if (isValid(x, y))
-					{
-						if (!closedList[x][y] && isUnBlocked(map, Pair(x, y)))
-						{
-							openList.insert(std::make_pair(x, y));
-
-							m_range.push_back(std::make_pair(x, y));
-						}
-					}
-				}
+				result.m_cost[adjacentLocal] = sucCost;
+				result.m_parent[adjacentLocal] = p.second;
+				openList.push(openEntry(sucCost, adjacentLocal));
+				PATH_STAT(m_stats.m_pushes++);
 			}
-			++currentDepth;
 		}
 	}
-}
\ No newline at end of file
+	return result;
+}
+
+ReachabilityMap Pathfinding::findAvailableTiles(Map &map, const Entity& entity, Pair src)
+{
+	return findAvailableTiles(map.getPathGrid(), src, entity.getMovementPoints(), &map.getZoneOfControl(entity.getFaction()));
+}
+
+ReachabilityMap::ReachabilityMap(const PathGrid& grid, Pair source, float movementPoints) :
+	m_source(source),
+	m_windowOrigin(source),
+	m_windowSize(0, 0),
+	m_movementPoints(movementPoints)
+{
+	if (!grid.inBounds(source) || movementPoints < 0.0f)
+		return;
+
+	//A hex step never moves more than one row or column, so nothing further than this can be reached
+	const int range = static_cast<int>(movementPoints / PathGrid::MIN_MOVEMENT_COST);
+	const std::pair<int, int> dimensions = grid.getDimensions();
+	m_windowOrigin = Pair(std::max(0, source.first - range), std::max(0, source.second - range));
+	m_windowSize = Pair(
+		std::min(dimensions.first, source.first + range + 1) - m_windowOrigin.first,
+		std::min(dimensions.second, source.second + range + 1) - m_windowOrigin.second);
+
+	m_cost.assign(m_windowSize.first * m_windowSize.second, FLT_MAX);
+	m_parent.assign(m_windowSize.first * m_windowSize.second, -1);
+}
+
+int ReachabilityMap::getLocalIndex(Pair coord) const
+{
+	const int x = coord.first - m_windowOrigin.first;
+	const int y = coord.second - m_windowOrigin.second;
+	if (x < 0 || y < 0 || x >= m_windowSize.first || y >= m_windowSize.second)
+		return -1;
+	return x + y * m_windowSize.first;
+}
+
+Pair ReachabilityMap::getLocalCoordinate(int localIndex) const
+{
+	return Pair(m_windowOrigin.first + localIndex % m_windowSize.first,
+		m_windowOrigin.second + localIndex / m_windowSize.first);
+}
+
+bool ReachabilityMap::isReachable(Pair coord) const
+{
+	const int local = getLocalIndex(coord);
+	return local != -1 && m_cost[local] != FLT_MAX;
+}
+
+float ReachabilityMap::getCost(Pair coord) const
+{
+	const int local = getLocalIndex(coord);
+	if (local == -1)
+		return FLT_MAX;
+	return m_cost[local];
+}
+
+std::vector<Pair> ReachabilityMap::getPath(Pair dest) const
+{
+	std::vector<Pair> path;
+	int local = getLocalIndex(dest);
+	if (local == -1 || m_cost[local] == FLT_MAX)
+		return path;
+
+	while (m_parent[local] != local)
+	{
+		path.push_back(getLocalCoordinate(local));
+		local = m_parent[local];
+	}
+	path.push_back(getLocalCoordinate(local));
+	return path;
+}
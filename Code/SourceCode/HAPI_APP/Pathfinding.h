@@ -1,39 +1,118 @@
 #pragma once
-#include <iostream>
-#include <stack>
-#include <set>
+#include <float.h>
 #include <vector>
+#include "MapListener.h"
+#include "PathCache.h"
+#include "PathStats.h"
+#include "ZoneOfControl.h"
 
 class Map;
+class Entity;
+class PathGrid;
 struct Tile;
 
 typedef std::pair<int, int> Pair;
 
-typedef std::pair<double, std::pair<int, int>> pPair;
-
-struct cell
+//Every tile reachable from a source within a movement budget, with the cost and parent of each.
+//Only a window around the source that the budget could possibly cover is stored.
+class ReachabilityMap
 {
-	int parent_i, parent_j = 0;
-	double f, g, h = 0.0;
+	friend class Pathfinding;
+private:
+	Pair m_source;
+	Pair m_windowOrigin;
+	Pair m_windowSize;
+	float m_movementPoints;
+	std::vector<float> m_cost;
+	std::vector<int> m_parent;
+	std::vector<Pair> m_tiles;
+
+	int getLocalIndex(Pair coord) const;
+	Pair getLocalCoordinate(int localIndex) const;
+public:
+	ReachabilityMap(const PathGrid& grid, Pair source, float movementPoints);
+	Pair getSource() const { return m_source; }
+	float getMovementPoints() const { return m_movementPoints; }
+	bool isReachable(Pair coord) const;
+	//Returns FLT_MAX for tiles that can't be reached
+	float getCost(Pair coord) const;
+	//Path from dest back to the source, same order as getPathTrace. Empty if dest can't be reached
+	std::vector<Pair> getPath(Pair dest) const;
+	//Reachable tiles in the order they were settled, cheapest first, starting with the source
+	const std::vector<Pair>& getTiles() const { return m_tiles; }
 };
 
-class Pathfinding
+class Pathfinding : public IMapListener
 {
 public:
 	Pathfinding();
+	//Registers with the map so findCachedPath hears about tiles changing, and removes itself again when destroyed
+	Pathfinding(Map& map);
+	//findCachedPath caches searches of this grid, pass every change to it on to onTileChanged
+	Pathfinding(const PathGrid& grid);
 	~Pathfinding();
-	bool isValid(int row, int col)const;
-	bool isUnBlocked(Map &map, Pair coord)const;
-	bool isDestination(int row, int col, Pair dest)const;
-	double calculateHeuristicValue(int row, int col, Pair dest)const;
-	void tracePath(const std::vector<std::vector<cell>>& cellDetails, Pair dest);
+	//Registered listeners can't be copied, the copy wouldn't be told about changes
+	Pathfinding(const Pathfinding&) = delete;
+	Pathfinding& operator=(const Pathfinding&) = delete;
+	//Result goes to getPathTrace. Not safe to share between threads, use a PathRequestService for that
 	void aStarSearch(Map &map, Pair src, Pair dest);
-	void findAvailableTiles(Pair src, Map &map, int depth);
+	//Bounded Dijkstra from src, every tile that costs no more than movementPoints to reach.
+	//With a zone of control, tiles next to enemies cost extra or can be entered but not left, depending on its rule.
+	ReachabilityMap findAvailableTiles(const PathGrid& grid, Pair src, float movementPoints, const ZoneOfControl* zoc = nullptr);
+	//Uses the zone of control of the entity's faction
+	ReachabilityMap findAvailableTiles(Map &map, const Entity& entity, Pair src);
+	//A* over the path grid, path is from dest back to src like getPathTrace. Empty if there is no route.
+	//A route only ends on a tile that stops movement in the zone of control, it never passes through one.
+	std::vector<Pair> findPath(const PathGrid& grid, Pair src, Pair dest, ePathPolicy policy = eAvoidShips, const ZoneOfControl* zoc = nullptr);
+	//Path to whichever goal is cheapest to reach, stopping as soon as one is, so a set of candidates costs about one search.
+	//Same order as findPath, empty if no goal can be reached. goalMask has a flag per tile, see PathGrid::getTilesOfType.
+	std::vector<Pair> findNearestGoal(const PathGrid& grid, Pair src, const std::vector<Pair>& goals, ePathPolicy policy = eAvoidShips);
+	std::vector<Pair> findNearestGoal(const PathGrid& grid, Pair src, const std::vector<bool>& goalMask, ePathPolicy policy = eAvoidShips);
+	//Paths to the k cheapest goals to reach, nearest first. Fewer if not that many can be reached
+	std::vector<std::vector<Pair>> findNearestGoals(const PathGrid& grid, Pair src, const std::vector<Pair>& goals, int k, ePathPolicy policy = eAvoidShips);
+	std::vector<std::vector<Pair>> findNearestGoals(const PathGrid& grid, Pair src, const std::vector<bool>& goalMask, int k, ePathPolicy policy = eAvoidShips);
+	//findPath that reuses an earlier result until a tile along it changes.
+	//Only searches of the grid this was made with are cached, anything else is a plain findPath.
+	std::vector<Pair> findCachedPath(const PathGrid& grid, Pair src, Pair dest, ePathPolicy policy = eAvoidShips);
+	void onTileChanged(std::pair<int, int> coord, eTileChange change) override;
+	PathCache& getPathCache() { return m_pathCache; }
 	std::vector<Pair> getPathTrace() { return m_path; };
 	std::vector<Pair> getMovementRange() { return m_range; };
+	//Tiles expanded by the last findPath or findAvailableTiles
+	unsigned int getLastExpansions() const { return m_lastExpansions; }
+	//Totals for every search since the last reset, these stay at zero when PATH_INSTRUMENTATION is off
+	const PathSearchStats& getStats() const { return m_stats; }
+	void resetStats() { m_stats = PathSearchStats(); }
+	//Called as searches start, expand tiles and finish, only when PATH_INSTRUMENTATION is on
+	void setTraceCallback(PathTraceCallback callback) { m_traceCallback = callback; }
 private:
+	//Map the cache is registered with, nullptr if made without one
+	Map* m_map;
+	//Grid whose searches are cached, nullptr if made without one
+	const PathGrid* m_cachedGrid;
 	std::vector<Pair> m_path;
 	std::vector<Pair> m_range;
-	int m_size;
+	PathCache m_pathCache;
+	unsigned int m_lastExpansions;
+	PathSearchStats m_stats;
+	PathTraceCallback m_traceCallback;
+
+	//Search workspace kept between searches, an entry only counts when its stamp matches m_searchStamp
+	std::vector<float> m_searchCost;
+	std::vector<int> m_searchParent;
+	std::vector<unsigned int> m_searchStamps;
+	unsigned int m_searchStamp;
+	//Goals of a list search are marked with the current search stamp
+	std::vector<unsigned int> m_goalStamps;
+
+	void prepareWorkspace(int size);
+	void trace(ePathTraceEvent event, int tile, float cost) const { if (m_traceCallback) m_traceCallback(event, tile, cost); }
+	void recordFailure(int tile);
+	//Search shared by the nearest goal functions, fills found with the first k goals settled.
+	//heuristicGoals is used to guide the search when it is short enough to be worth checking per tile.
+	void searchGoals(const PathGrid& grid, Pair src, const std::vector<bool>* goalMask, const std::vector<Pair>* heuristicGoals,
+		int k, ePathPolicy policy, std::vector<int>& found);
+	std::vector<Pair> getSearchPath(const PathGrid& grid, int srcIndex, int destIndex) const;
+	float getSearchCost(int index) const { return m_searchStamps[index] == m_searchStamp ? m_searchCost[index] : FLT_MAX; }
 };
 
@@ -0,0 +1,104 @@
+#include "ScaledTileFrames.h"
+#include <algorithm>
+#include <math.h>
+
+using namespace HAPISPACE;
+
+ScaledTileFrames::ScaledTileFrames() :
+	m_spriteSheet(nullptr),
+	m_levels(),
+	m_useCount(0)
+{
+}
+
+void ScaledTileFrames::setSpriteSheet(std::shared_ptr<SpriteSheet> spriteSheet)
+{
+	m_spriteSheet = spriteSheet;
+	m_levels.clear();
+}
+
+void ScaledTileFrames::buildLevel(ScaleLevel& level) const
+{
+	//Scaled frame by frame rather than the whole sheet so frame edges never fall between texels
+	const int frameCount = m_spriteSheet->GetNumFrames();
+	level.m_frames.resize(frameCount);
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		const RectangleI frameRect = m_spriteSheet->GetFrameRect(frame);
+		const Surface unscaled(*m_spriteSheet->GetSurface(), frameRect);
+		level.m_frames[frame] = unscaled.CreateScaled(
+			std::max(1, (int)floor(frameRect.Width() * level.m_scale + 0.5f)),
+			std::max(1, (int)floor(frameRect.Height() * level.m_scale + 0.5f)),
+			EFilter::eNearest);
+	}
+}
+
+ScaledTileFrames::ScaleLevel& ScaledTileFrames::getLevel(float scale)
+{
+	m_useCount++;
+	for (ScaleLevel& level : m_levels)
+	{
+		if (level.m_scale == scale)
+		{
+			level.m_lastUsed = m_useCount;
+			return level;
+		}
+	}
+
+	//Reuse the level used longest ago once there are enough
+	if (m_levels.size() >= MAX_LEVELS)
+	{
+		auto oldest = std::min_element(m_levels.begin(), m_levels.end(),
+			[](const ScaleLevel& a, const ScaleLevel& b) { return a.m_lastUsed < b.m_lastUsed; });
+		m_levels.erase(oldest);
+	}
+	m_levels.push_back(ScaleLevel{ scale, std::vector<std::shared_ptr<Surface>>(), std::vector<FrameRowSpans>(), m_useCount });
+	if (m_spriteSheet)
+		buildLevel(m_levels.back());
+	return m_levels.back();
+}
+
+const std::vector<std::shared_ptr<Surface>>& ScaledTileFrames::getFrames(float scale)
+{
+	return getLevel(scale).m_frames;
+}
+
+FrameRowSpans ScaledTileFrames::findRowSpans(const Surface& frame)
+{
+	FrameRowSpans spans;
+	spans.m_opaque.resize(frame.Height(), TexelSpan{ 0, 0 });
+	spans.m_visible.resize(frame.Height(), TexelSpan{ 0, 0 });
+	for (int y = 0; y < frame.Height(); y++)
+	{
+		int runStart = 0;
+		for (int x = 0; x <= frame.Width(); x++)
+		{
+			const BYTE alpha = x < frame.Width() ? frame.GetPixel(VectorI(x, y)).alpha : 0;
+			if (alpha != 0)
+			{
+				if (spans.m_visible[y].isEmpty())
+					spans.m_visible[y].m_first = x;
+				spans.m_visible[y].m_last = x + 1;
+			}
+			if (alpha != 255)
+			{
+				if (x - runStart > spans.m_opaque[y].m_last - spans.m_opaque[y].m_first)
+					spans.m_opaque[y] = TexelSpan{ runStart, x };
+				runStart = x + 1;
+			}
+		}
+	}
+	return spans;
+}
+
+const std::vector<FrameRowSpans>& ScaledTileFrames::getRowSpans(float scale)
+{
+	ScaleLevel& level = getLevel(scale);
+	if (level.m_rowSpans.size() != level.m_frames.size())
+	{
+		level.m_rowSpans.clear();
+		for (const std::shared_ptr<Surface>& frame : level.m_frames)
+			level.m_rowSpans.push_back(findRowSpans(*frame));
+	}
+	return level.m_rowSpans;
+}
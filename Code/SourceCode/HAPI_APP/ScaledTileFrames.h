@@ -0,0 +1,54 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <HAPISprites_lib.h>
+
+//Texels [m_first, m_last) of one row of a frame, empty when m_last isn't past m_first
+struct TexelSpan
+{
+	int m_first;
+	int m_last;
+
+	bool isEmpty() const { return m_last <= m_first; }
+};
+
+//Per row of a frame, the longest run of fully opaque texels and the span from its first to its last texel that isn't fully transparent
+struct FrameRowSpans
+{
+	std::vector<TexelSpan> m_opaque;
+	std::vector<TexelSpan> m_visible;
+};
+
+//Each frame of the tile sheet copied out and scaled to a draw scale, so tiles can be drawn with the unscaled blit.
+//The last few scales used are kept, so zooming in and out again doesn't scale the frames again.
+class ScaledTileFrames
+{
+private:
+	struct ScaleLevel
+	{
+		float m_scale;
+		std::vector<std::shared_ptr<HAPISPACE::Surface>> m_frames;
+		//Only worked out once asked for
+		std::vector<FrameRowSpans> m_rowSpans;
+		unsigned int m_lastUsed;
+	};
+
+	std::shared_ptr<HAPISPACE::SpriteSheet> m_spriteSheet;
+	std::vector<ScaleLevel> m_levels;
+	unsigned int m_useCount;
+
+	void buildLevel(ScaleLevel& level) const;
+	ScaleLevel& getLevel(float scale);
+	static FrameRowSpans findRowSpans(const HAPISPACE::Surface& frame);
+public:
+	static constexpr size_t MAX_LEVELS = 4;
+
+	ScaledTileFrames();
+
+	//Throws away every scale built from the previous sheet
+	void setSpriteSheet(std::shared_ptr<HAPISPACE::SpriteSheet> spriteSheet);
+	//Frames at the given scale indexed by frame number, scaled the first time a scale is asked for
+	const std::vector<std::shared_ptr<HAPISPACE::Surface>>& getFrames(float scale);
+	//Row spans of the frames at the given scale, in the same order
+	const std::vector<FrameRowSpans>& getRowSpans(float scale);
+};
@@ -0,0 +1,273 @@
+#include "TerrainChunkCache.h"
+#include "Map.h"
+#include "DrawList.h"
+#include <algorithm>
+#include <climits>
+#include <math.h>
+
+using namespace HAPISPACE;
+
+TerrainChunkCache::TerrainChunkCache(std::pair<int, int> mapDimensions, int rowHeight) :
+	m_mapDimensions(mapDimensions),
+	m_chunkSize(0, 0),
+	m_chunkCounts(0, 0),
+	m_frameSize(0, 0),
+	m_rowHeight(rowHeight),
+	m_columnSpacing(0.0f),
+	m_overhang(0, 0),
+	m_chunks(),
+	m_lastDrawn(),
+	m_baked(),
+	m_drawCount(0),
+	m_scaledFrames(),
+	m_bakeOrder(),
+	m_bakePositions(),
+	m_bakeSlots(),
+	m_coveringTiles(),
+	m_bakedScale(0.0f),
+	m_skipCoveredPixels(false)
+{
+}
+
+void TerrainChunkCache::setLayout(const Tile& firstTile)
+{
+	m_frameSize = std::pair<int, int>(firstTile.m_sprite->FrameWidth(), firstTile.m_sprite->FrameHeight());
+	m_columnSpacing = (float)m_frameSize.first * 3 / 4;
+	//Even columns sit half a row lower so hang over further
+	m_overhang.first = (int)ceil(m_frameSize.first / m_columnSpacing) - 1;
+	m_overhang.second = (int)ceil((m_frameSize.second + 0.5f * m_rowHeight) / m_rowHeight) - 1;
+	//Every tile shares the one sheet
+	m_scaledFrames.setSpriteSheet(firstTile.m_sprite->GetSpritesheet());
+}
+
+void TerrainChunkCache::setScale(float scale)
+{
+	clear();
+	m_bakedScale = scale;
+	m_chunkSize.first = std::max(1, (int)(CHUNK_PIXELS / (m_columnSpacing * scale)));
+	m_chunkSize.second = std::max(1, (int)(CHUNK_PIXELS / (m_rowHeight * scale)));
+	m_chunkCounts.first = (m_mapDimensions.first + m_chunkSize.first - 1) / m_chunkSize.first;
+	m_chunkCounts.second = (m_mapDimensions.second + m_chunkSize.second - 1) / m_chunkSize.second;
+	m_chunks.assign(m_chunkCounts.first * m_chunkCounts.second, nullptr);
+	m_lastDrawn.assign(m_chunks.size(), 0);
+}
+
+void TerrainChunkCache::resetChunk(int chunk)
+{
+	if (!m_chunks[chunk])
+		return;
+	m_chunks[chunk].reset();
+	m_baked.erase(std::find(m_baked.begin(), m_baked.end(), chunk));
+}
+
+void TerrainChunkCache::evictChunks()
+{
+	if (m_baked.size() <= MAX_BAKED_CHUNKS)
+		return;
+
+	//Surfaces still in a draw list stay alive until it is cleared
+	std::sort(m_baked.begin(), m_baked.end(), [&](int a, int b) { return m_lastDrawn[a] > m_lastDrawn[b]; });
+	while (m_baked.size() > MAX_BAKED_CHUNKS && m_lastDrawn[m_baked.back()] != m_drawCount)
+	{
+		m_chunks[m_baked.back()].reset();
+		m_baked.pop_back();
+	}
+}
+
+RectangleI TerrainChunkCache::getChunkRect(int chunkX, int chunkY, float scale) const
+{
+	//Inner edges are rounded down on both sides so neighbouring chunks meet exactly, the map edges are rounded out
+	const bool lastColumn = chunkX + 1 == m_chunkCounts.first;
+	const bool lastRow = chunkY + 1 == m_chunkCounts.second;
+	const float left = chunkX * m_chunkSize.first * m_columnSpacing;
+	const float right = lastColumn ?
+		(m_mapDimensions.first - 1) * m_columnSpacing + m_frameSize.first : (chunkX + 1) * m_chunkSize.first * m_columnSpacing;
+	const float top = (float)chunkY * m_chunkSize.second * m_rowHeight;
+	const float bottom = lastRow ?
+		(m_mapDimensions.second - 0.5f) * m_rowHeight + m_frameSize.second : (float)(chunkY + 1) * m_chunkSize.second * m_rowHeight;
+
+	return RectangleI(
+		(int)floor(left * scale),
+		lastColumn ? (int)ceil(right * scale) : (int)floor(right * scale),
+		(int)floor(top * scale),
+		lastRow ? (int)ceil(bottom * scale) : (int)floor(bottom * scale));
+}
+
+void TerrainChunkCache::bakeChunk(const std::vector<Tile>& tiles, int chunkX, int chunkY, float scale)
+{
+	const RectangleI rect = getChunkRect(chunkX, chunkY, scale);
+	std::shared_ptr<Surface> chunk = std::make_shared<Surface>(std::max(1, rect.Width()), std::max(1, rect.Height()));
+
+	const int firstX = std::max(0, chunkX * m_chunkSize.first - m_overhang.first);
+	const int lastX = std::min(m_mapDimensions.first - 1, (chunkX + 1) * m_chunkSize.first - 1);
+	const int firstY = std::max(0, chunkY * m_chunkSize.second - m_overhang.second);
+	const int lastY = std::min(m_mapDimensions.second - 1, (chunkY + 1) * m_chunkSize.second - 1);
+
+	const std::pair<int, int> first(firstX, firstY);
+	const std::pair<int, int> last(lastX, lastY);
+	HexDrawOrder::buildOrder(first, last, m_mapDimensions.first, m_bakeOrder);
+	m_bakePositions.clear();
+	for (int index : m_bakeOrder)
+	{
+		const int x = index % m_mapDimensions.first;
+		const int y = index / m_mapDimensions.first;
+		const float yPos = ((x & 1) ? (float)y : 0.5f + y) * m_rowHeight;
+		m_bakePositions.push_back(VectorF(floor(x * m_columnSpacing * scale) - rect.left, floor(yPos * scale) - rect.top));
+	}
+
+	const std::vector<std::shared_ptr<Surface>>& frames = m_scaledFrames.getFrames(scale);
+	if (!m_skipCoveredPixels)
+	{
+		for (size_t slot = 0; slot < m_bakeOrder.size(); slot++)
+			chunk->Blit(frames[tiles[m_bakeOrder[slot]].m_sprite->GetFrameNumber()], Transform(m_bakePositions[slot]));
+	}
+	else
+	{
+		const int blockWidth = lastX - firstX + 1;
+		m_bakeSlots.assign(blockWidth * (lastY - firstY + 1), -1);
+		for (size_t slot = 0; slot < m_bakeOrder.size(); slot++)
+			m_bakeSlots[(m_bakeOrder[slot] % m_mapDimensions.first - firstX) + (m_bakeOrder[slot] / m_mapDimensions.first - firstY) * blockWidth] = (int)slot;
+
+		const std::vector<FrameRowSpans>& rowSpans = m_scaledFrames.getRowSpans(scale);
+		for (size_t slot = 0; slot < m_bakeOrder.size(); slot++)
+		{
+			const RectangleI uncovered = findUncoveredRect(tiles, (int)slot, first, last, rowSpans);
+			if (uncovered.Width() > 0 && uncovered.Height() > 0)
+			{
+				chunk->Blit(frames[tiles[m_bakeOrder[slot]].m_sprite->GetFrameNumber()],
+					Transform(VectorF(m_bakePositions[slot].x + uncovered.left, m_bakePositions[slot].y + uncovered.top)), uncovered);
+			}
+		}
+	}
+	m_chunks[chunkX + chunkY * m_chunkCounts.first] = chunk;
+	m_baked.push_back(chunkX + chunkY * m_chunkCounts.first);
+}
+
+RectangleI TerrainChunkCache::findUncoveredRect(const std::vector<Tile>& tiles, int slot, std::pair<int, int> first, std::pair<int, int> last,
+	const std::vector<FrameRowSpans>& rowSpans)
+{
+	const int index = m_bakeOrder[slot];
+	const int x = index % m_mapDimensions.first;
+	const int y = index / m_mapDimensions.first;
+	const FrameRowSpans& spans = rowSpans[tiles[index].m_sprite->GetFrameNumber()];
+
+	//Tiles drawn later sit lower, or in the same row half a row lower, so only the ones below can cover this one
+	m_coveringTiles.clear();
+	const int blockWidth = last.first - first.first + 1;
+	for (int coverY = y; coverY <= std::min(last.second, y + m_overhang.second); coverY++)
+	{
+		for (int coverX = std::max(first.first, x - m_overhang.first); coverX <= std::min(last.first, x + m_overhang.first); coverX++)
+		{
+			const int coverSlot = m_bakeSlots[(coverX - first.first) + (coverY - first.second) * blockWidth];
+			if (coverSlot <= slot)
+				continue;
+			m_coveringTiles.push_back(CoveringTile{ &rowSpans[tiles[m_bakeOrder[coverSlot]].m_sprite->GetFrameNumber()],
+				(int)(m_bakePositions[coverSlot].x - m_bakePositions[slot].x), (int)(m_bakePositions[coverSlot].y - m_bakePositions[slot].y) });
+		}
+	}
+
+	int top = (int)spans.m_visible.size();
+	int bottom = 0;
+	int left = INT_MAX;
+	int right = INT_MIN;
+	for (int row = 0; row < (int)spans.m_visible.size(); row++)
+	{
+		//Trimmed from either end by any covering span over that end until none is
+		TexelSpan showing = spans.m_visible[row];
+		bool trimmed = true;
+		while (trimmed && !showing.isEmpty())
+		{
+			trimmed = false;
+			for (const CoveringTile& cover : m_coveringTiles)
+			{
+				const int coverRow = row - cover.m_offsetY;
+				if (coverRow < 0 || coverRow >= (int)cover.m_rowSpans->m_opaque.size())
+					continue;
+				const TexelSpan& opaque = cover.m_rowSpans->m_opaque[coverRow];
+				if (opaque.isEmpty())
+					continue;
+				const int coverFirst = opaque.m_first + cover.m_offsetX;
+				const int coverLast = opaque.m_last + cover.m_offsetX;
+				if (coverFirst <= showing.m_first && coverLast > showing.m_first)
+				{
+					showing.m_first = coverLast;
+					trimmed = true;
+				}
+				if (coverLast >= showing.m_last && coverFirst < showing.m_last)
+				{
+					showing.m_last = coverFirst;
+					trimmed = true;
+				}
+			}
+		}
+		if (showing.isEmpty())
+			continue;
+		top = std::min(top, row);
+		bottom = row + 1;
+		left = std::min(left, showing.m_first);
+		right = std::max(right, showing.m_last);
+	}
+	return top < bottom ? RectangleI(left, right, top, bottom) : RectangleI(0, 0, 0, 0);
+}
+
+void TerrainChunkCache::setSkipCoveredPixels(bool skip)
+{
+	if (skip != m_skipCoveredPixels)
+	{
+		m_skipCoveredPixels = skip;
+		clear();
+	}
+}
+
+void TerrainChunkCache::draw(const std::vector<Tile>& tiles, const TileRange& visible, float scale, std::pair<int, int> offset,
+	DrawList& drawList)
+{
+	if (tiles.empty() || visible.isEmpty())
+		return;
+	if (m_columnSpacing == 0.0f)
+		setLayout(tiles[0]);
+	if (scale != m_bakedScale)
+		setScale(scale);
+	m_drawCount++;
+
+	//Visible tiles can be baked into chunks to the right or below them that they hang over into
+	const int lastChunkX = std::min(m_chunkCounts.first - 1, (visible.m_last.first + m_overhang.first) / m_chunkSize.first);
+	const int lastChunkY = std::min(m_chunkCounts.second - 1, (visible.m_last.second + m_overhang.second) / m_chunkSize.second);
+	for (int chunkY = visible.m_first.second / m_chunkSize.second; chunkY <= lastChunkY; chunkY++)
+	{
+		for (int chunkX = visible.m_first.first / m_chunkSize.first; chunkX <= lastChunkX; chunkX++)
+		{
+			const RectangleI rect = getChunkRect(chunkX, chunkY, scale);
+			std::shared_ptr<Surface>& chunk = m_chunks[chunkX + chunkY * m_chunkCounts.first];
+			if (!chunk)
+				bakeChunk(tiles, chunkX, chunkY, scale);
+			m_lastDrawn[chunkX + chunkY * m_chunkCounts.first] = m_drawCount;
+			//Chunks don't overlap so they can share a depth
+			drawList.add(eLayerTerrain, 0.0f, chunk, RectangleI(chunk->Width(), chunk->Height()),
+				Transform(VectorF((float)(rect.left - offset.first), (float)(rect.top - offset.second))));
+		}
+	}
+	evictChunks();
+}
+
+void TerrainChunkCache::onTerrainChanged(std::pair<int, int> coord)
+{
+	//Nothing baked before the first draw
+	if (m_chunks.empty())
+		return;
+	//A tile is baked into its own chunk and any to the right or below that it hangs over into
+	const int lastChunkX = std::min(m_chunkCounts.first - 1, (coord.first + m_overhang.first) / m_chunkSize.first);
+	const int lastChunkY = std::min(m_chunkCounts.second - 1, (coord.second + m_overhang.second) / m_chunkSize.second);
+	for (int chunkY = coord.second / m_chunkSize.second; chunkY <= lastChunkY; chunkY++)
+	{
+		for (int chunkX = coord.first / m_chunkSize.first; chunkX <= lastChunkX; chunkX++)
+			resetChunk(chunkX + chunkY * m_chunkCounts.first);
+	}
+}
+
+void TerrainChunkCache::clear()
+{
+	for (int chunk : m_baked)
+		m_chunks[chunk].reset();
+	m_baked.clear();
+}
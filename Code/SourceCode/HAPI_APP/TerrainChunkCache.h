@@ -0,0 +1,88 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+#include <HAPISprites_lib.h>
+#include "HexDrawOrder.h"
+#include "ScaledTileFrames.h"
+
+class DrawList;
+
+struct Tile;
+struct TileRange;
+
+//Terrain baked into surfaces of about CHUNK_PIXELS square so drawMap submits a few chunks instead of every tile.
+//Each chunk covers its own rectangle of the map with no overlap. Tiles from neighbouring chunks that hang over into it
+//are baked in as well, in the same order drawMap used, so the result matches drawing each tile.
+//Chunks are baked at the scale they are drawn at and only when they first come into view,
+//after a tile in them changes or when the scale changes. How many hexes a chunk holds depends on the scale,
+//and only the MAX_BAKED_CHUNKS most recently drawn are kept, so memory doesn't grow with panning or zooming.
+class TerrainChunkCache
+{
+private:
+	//A tile drawn after the one being baked that may cover part of it, offset from it in pixels
+	struct CoveringTile
+	{
+		const FrameRowSpans* m_rowSpans;
+		int m_offsetX;
+		int m_offsetY;
+	};
+
+	std::pair<int, int> m_mapDimensions;
+	//Hexes across and down each chunk at the baked scale
+	std::pair<int, int> m_chunkSize;
+	std::pair<int, int> m_chunkCounts;
+	//Size of a tile frame and the spacing between tiles in unscaled pixels, read from the first tile when first drawn
+	std::pair<int, int> m_frameSize;
+	int m_rowHeight;
+	float m_columnSpacing;
+	//How many columns to the left and rows above can hang over into a tile's rectangle
+	std::pair<int, int> m_overhang;
+	std::vector<std::shared_ptr<HAPISPACE::Surface>> m_chunks;
+	//Draw each chunk was last used in, to throw away the least recently used first
+	std::vector<unsigned int> m_lastDrawn;
+	//Indices of the chunks that are baked
+	std::vector<int> m_baked;
+	unsigned int m_drawCount;
+	//Tile frames at the draw scale, so baking a chunk only needs unscaled blits
+	ScaledTileFrames m_scaledFrames;
+	//Draw order of the block being baked, kept to reuse its memory as every chunk is a different block
+	std::vector<int> m_bakeOrder;
+	//Where each tile of m_bakeOrder goes in the chunk
+	std::vector<HAPISPACE::VectorF> m_bakePositions;
+	//Position in m_bakeOrder of each tile of the block, by position in the block
+	std::vector<int> m_bakeSlots;
+	std::vector<CoveringTile> m_coveringTiles;
+	float m_bakedScale;
+	bool m_skipCoveredPixels;
+
+	void setLayout(const Tile& firstTile);
+	//Sizes the chunks for the scale, throwing away every baked one
+	void setScale(float scale);
+	void resetChunk(int chunk);
+	//Throws away the least recently drawn chunks past MAX_BAKED_CHUNKS, never any drawn this time
+	void evictChunks();
+	//Scaled pixel rectangle the chunk covers, relative to the top left of the map
+	HAPISPACE::RectangleI getChunkRect(int chunkX, int chunkY, float scale) const;
+	void bakeChunk(const std::vector<Tile>& tiles, int chunkX, int chunkY, float scale);
+	//Part of the frame of the tile at slot in m_bakeOrder left showing by the opaque texels of the tiles drawn after it.
+	//Only rows with something showing are kept and each row is only trimmed from its ends, so it may still hold covered texels.
+	HAPISPACE::RectangleI findUncoveredRect(const std::vector<Tile>& tiles, int slot, std::pair<int, int> first, std::pair<int, int> last,
+		const std::vector<FrameRowSpans>& rowSpans);
+public:
+	//Width and height of a chunk in pixels at the draw scale, a chunk is never less than one hex
+	static constexpr int CHUNK_PIXELS = 512;
+	static constexpr size_t MAX_BAKED_CHUNKS = 48;
+
+	//rowHeight is the vertical distance between tiles in a column, less than the frame height as tiles overlap
+	TerrainChunkCache(std::pair<int, int> mapDimensions, int rowHeight);
+
+	//Adds the chunks holding part of a visible tile to the terrain layer, so the cost follows the screen size not the map size
+	void draw(const std::vector<Tile>& tiles, const TileRange& visible, float scale, std::pair<int, int> offset, DrawList& drawList);
+	//Rebakes the chunks the tile is drawn in next time they are drawn
+	void onTerrainChanged(std::pair<int, int> coord);
+	void clear();
+	//Off by default. Leaves out the parts of tiles that tiles drawn after them cover when baking, which saves blending
+	//texels that would be overwritten. Chunks look exactly the same either way.
+	void setSkipCoveredPixels(bool skip);
+};
@@ -0,0 +1,163 @@
+#include "TimeSlicedSearch.h"
+#include <algorithm>
+#include <chrono>
+
+TimeSlicedSearch::TimeSlicedSearch(const PathGrid& grid, std::pair<int, int> src, std::pair<int, int> dest, ePathPolicy policy) :
+	m_grid(grid),
+	m_src(-1),
+	m_dest(-1),
+	m_policy(policy),
+	m_status(eSearchFailed),
+	m_best(-1),
+	m_bestDistance(INT_MAX),
+	m_expansions(0)
+{
+	if (!grid.inBounds(src) || !grid.inBounds(dest))
+		return;
+
+	m_src = grid.getIndex(src);
+	m_dest = grid.getIndex(dest);
+	m_best = m_src;
+	m_bestDistance = getHeuristicDistance(m_src);
+	if (!grid.canEnter(m_dest, policy))
+	{
+		finish(eSearchFailed);
+		return;
+	}
+
+	m_nodes[m_src] = Node{ 0.0f, m_src };
+	m_openList.push(openEntry(m_bestDistance * PathGrid::MIN_MOVEMENT_COST, m_src));
+	m_status = eSearchRunning;
+}
+
+eSearchStatus TimeSlicedSearch::step(unsigned int maxExpansions)
+{
+	if (m_status != eSearchRunning)
+		return m_status;
+
+	for (unsigned int expanded = 0; expanded < maxExpansions; )
+	{
+		if (m_openList.empty())
+			return finish(eSearchFailed);
+
+		const openEntry p = m_openList.top();
+		m_openList.pop();
+
+		const float g = m_nodes[p.second].m_cost;
+		const int distance = getHeuristicDistance(p.second);
+		if (p.first > g + distance * PathGrid::MIN_MOVEMENT_COST)
+			continue;
+		expanded++;
+		m_expansions++;
+
+		if (distance < m_bestDistance)
+		{
+			m_best = p.second;
+			m_bestDistance = distance;
+		}
+		if (p.second == m_dest)
+			return finish(eSearchFound);
+
+		for (int direction = eNorth; direction <= eNorthWest; direction++)
+		{
+			const int adjacent = m_grid.getAdjacentIndex(p.second, direction);
+			if (adjacent == -1 || !m_grid.canEnter(adjacent, m_policy))
+				continue;
+
+			const float sucG = g + m_grid.getMovementCost(adjacent);
+			if (sucG < getCost(adjacent))
+			{
+				m_nodes[adjacent] = Node{ sucG, p.second };
+				m_openList.push(openEntry(sucG + getHeuristicDistance(adjacent) * PathGrid::MIN_MOVEMENT_COST, adjacent));
+			}
+		}
+	}
+	return m_status;
+}
+
+float TimeSlicedSearch::getCost(int index) const
+{
+	auto it = m_nodes.find(index);
+	return it == m_nodes.end() ? FLT_MAX : it->second.m_cost;
+}
+
+eSearchStatus TimeSlicedSearch::finish(eSearchStatus status)
+{
+	m_status = status;
+	m_path = tracePath();
+	std::unordered_map<int, Node>().swap(m_nodes);
+	std::priority_queue<openEntry, std::vector<openEntry>, std::greater<openEntry>>().swap(m_openList);
+	return m_status;
+}
+
+std::vector<std::pair<int, int>> TimeSlicedSearch::getBestPath() const
+{
+	return isDone() ? m_path : tracePath();
+}
+
+std::vector<std::pair<int, int>> TimeSlicedSearch::tracePath() const
+{
+	std::vector<std::pair<int, int>> path;
+	if (m_best == -1)
+		return path;
+
+	for (int index = m_best; index != m_src; index = m_nodes.at(index).m_parent)
+		path.push_back(m_grid.getCoordinate(index));
+	path.push_back(m_grid.getCoordinate(m_src));
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+PathSearchScheduler::PathSearchScheduler(const PathGrid& grid) :
+	m_grid(grid),
+	m_nextSearch(0),
+	m_nextSearchId(0),
+	m_budgetMicroseconds(DEFAULT_BUDGET_MICROSECONDS),
+	m_sliceExpansions(DEFAULT_SLICE_EXPANSIONS)
+{
+}
+
+int PathSearchScheduler::startSearch(std::pair<int, int> src, std::pair<int, int> dest, ePathPolicy policy)
+{
+	const int searchId = m_nextSearchId++;
+	m_searches[searchId] = std::unique_ptr<TimeSlicedSearch>(new TimeSlicedSearch(m_grid, src, dest, policy));
+	m_order.push_back(searchId);
+	return searchId;
+}
+
+void PathSearchScheduler::cancelSearch(int searchId)
+{
+	if (m_searches.erase(searchId) == 0)
+		return;
+	m_order.erase(std::remove(m_order.begin(), m_order.end(), searchId), m_order.end());
+}
+
+const TimeSlicedSearch* PathSearchScheduler::getSearch(int searchId) const
+{
+	auto it = m_searches.find(searchId);
+	return it == m_searches.end() ? nullptr : it->second.get();
+}
+
+void PathSearchScheduler::update()
+{
+	const auto start = std::chrono::steady_clock::now();
+	const auto budget = std::chrono::microseconds(m_budgetMicroseconds);
+
+	//Round robin so one long search can't starve the rest, picking up where last frame stopped
+	size_t idle = 0;
+	while (idle < m_order.size() && std::chrono::steady_clock::now() - start < budget)
+	{
+		if (m_nextSearch >= m_order.size())
+			m_nextSearch = 0;
+		TimeSlicedSearch& search = *m_searches[m_order[m_nextSearch]];
+		m_nextSearch++;
+
+		if (search.isDone())
+		{
+			idle++;
+			continue;
+		}
+		idle = 0;
+		search.step(m_sliceExpansions);
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <float.h>
+#include <limits.h>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "PathGrid.h"
+
+enum eSearchStatus
+{
+	eSearchRunning,
+	eSearchFound,
+	eSearchFailed
+};
+
+//A* that can be stopped after a number of expansions and carried on later, so a long search can be spread over
+//several frames. Until it finishes the best guess is the route to the tile found so far that is closest to the goal.
+//The grid has to outlive the search. Changes to it while the search runs are picked up by the tiles not yet expanded.
+//Only tiles the search reaches are stored, and once it finishes everything but the route is freed.
+class TimeSlicedSearch
+{
+private:
+	typedef std::pair<float, int> openEntry;
+	struct Node
+	{
+		float m_cost;
+		int m_parent;
+	};
+
+	const PathGrid& m_grid;
+	int m_src;
+	int m_dest;
+	ePathPolicy m_policy;
+	eSearchStatus m_status;
+	//Searches are interleaved, so each keeps its own sparse workspace rather than sharing one sized to the grid
+	std::unordered_map<int, Node> m_nodes;
+	std::priority_queue<openEntry, std::vector<openEntry>, std::greater<openEntry>> m_openList;
+	//Expanded tile closest to the goal, the end of the partial route
+	int m_best;
+	int m_bestDistance;
+	unsigned int m_expansions;
+	//Filled in when the search finishes
+	std::vector<std::pair<int, int>> m_path;
+
+	float getCost(int index) const;
+	std::vector<std::pair<int, int>> tracePath() const;
+	//Keeps the route and frees the workspace
+	eSearchStatus finish(eSearchStatus status);
+	int getHeuristicDistance(int index) const { return PathGrid::getDistance(m_grid.getCoordinate(index), m_grid.getCoordinate(m_dest)); }
+public:
+	TimeSlicedSearch(const PathGrid& grid, std::pair<int, int> src, std::pair<int, int> dest, ePathPolicy policy = eAvoidShips);
+
+	//Expands up to maxExpansions tiles, returns straight away once the search has finished
+	eSearchStatus step(unsigned int maxExpansions);
+	eSearchStatus getStatus() const { return m_status; }
+	bool isDone() const { return m_status != eSearchRunning; }
+	//The route once found, otherwise the best partial route so far. Start first, empty only if src was invalid
+	std::vector<std::pair<int, int>> getBestPath() const;
+	unsigned int getExpansions() const { return m_expansions; }
+};
+
+//Runs every live TimeSlicedSearch a slice at a time from the frame loop, stopping once the frame's budget is spent
+//so big AI turns are spread over frames instead of causing a hitch.
+class PathSearchScheduler
+{
+private:
+	const PathGrid& m_grid;
+	std::unordered_map<int, std::unique_ptr<TimeSlicedSearch>> m_searches;
+	std::vector<int> m_order;
+	size_t m_nextSearch;
+	int m_nextSearchId;
+	long long m_budgetMicroseconds;
+	unsigned int m_sliceExpansions;
+public:
+	//Fits alongside drawing in a 60 fps frame
+	static constexpr long long DEFAULT_BUDGET_MICROSECONDS = 2000;
+	//Expansions between checks of the clock
+	static constexpr unsigned int DEFAULT_SLICE_EXPANSIONS = 64;
+
+	PathSearchScheduler(const PathGrid& grid);
+
+	//Returns an id used to refer to the search from then on
+	int startSearch(std::pair<int, int> src, std::pair<int, int> dest, ePathPolicy policy = eAvoidShips);
+	void cancelSearch(int searchId);
+	//Returns nullptr for an unknown id. Finished searches are kept until cancelled.
+	const TimeSlicedSearch* getSearch(int searchId) const;
+
+	//Call once a frame, advances the unfinished searches in turn until the budget runs out
+	void update();
+	void setBudget(long long microseconds) { m_budgetMicroseconds = microseconds; }
+	long long getBudget() const { return m_budgetMicroseconds; }
+	void setSliceExpansions(unsigned int expansions) { m_sliceExpansions = expansions > 0 ? expansions : 1; }
+	size_t getSearchCount() const { return m_searches.size(); }
+};
@@ -0,0 +1,64 @@
+#include "TurnReachability.h"
+#include "Map.h"
+#include "Entity.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+std::shared_ptr<const TurnReachability> TurnReachability::build(const PathGrid& grid, const std::vector<ShipMovement>& ships,
+	const ZoneOfControl* zoc, unsigned int threadCount)
+{
+	std::shared_ptr<TurnReachability> result(new TurnReachability());
+	result->m_ships = ships;
+	result->m_reachability.resize(ships.size());
+	result->m_dimensions = grid.getDimensions();
+	for (size_t ship = 0; ship < ships.size(); ship++)
+	{
+		if (grid.inBounds(ships[ship].m_position))
+			result->m_shipAtTile[grid.getIndex(ships[ship].m_position)] = ship;
+	}
+
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, ships.size()));
+
+	//Workers take the next ship until there are none left, each with its own search workspace
+	std::atomic<size_t> nextShip(0);
+	auto work = [&]()
+	{
+		Pathfinding pathfinding;
+		for (size_t ship = nextShip++; ship < ships.size(); ship = nextShip++)
+		{
+			result->m_reachability[ship].reset(new ReachabilityMap(
+				pathfinding.findAvailableTiles(grid, ships[ship].m_position, ships[ship].m_movementPoints, zoc)));
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 1; i < threadCount; i++)
+		workers.emplace_back(work);
+	//The calling thread does its share too
+	work();
+	for (std::thread& worker : workers)
+		worker.join();
+	return result;
+}
+
+std::shared_ptr<const TurnReachability> TurnReachability::build(Map& map, faction movingFaction, unsigned int threadCount)
+{
+	std::vector<ShipMovement> ships;
+	for (const Tile& tile : *map.getMap())
+	{
+		if (tile.m_entityOnTile && tile.m_entityOnTile->getFaction() == movingFaction)
+			ships.push_back(ShipMovement{ tile.m_tileCoordinate, tile.m_entityOnTile->getMovementPoints() });
+	}
+	return build(map.getPathGrid(), ships, &map.getZoneOfControl(movingFaction), threadCount);
+}
+
+const ReachabilityMap* TurnReachability::find(std::pair<int, int> position) const
+{
+	if (position.first < 0 || position.second < 0 || position.first >= m_dimensions.first || position.second >= m_dimensions.second)
+		return nullptr;
+	auto it = m_shipAtTile.find(position.first + position.second * m_dimensions.first);
+	return it == m_shipAtTile.end() ? nullptr : m_reachability[it->second].get();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Pathfinding.h"
+
+class Map;
+class PathGrid;
+class ZoneOfControl;
+enum class faction;
+
+struct ShipMovement
+{
+	std::pair<int, int> m_position;
+	float m_movementPoints;
+};
+
+//Where every ship of a faction can move this turn, all worked out at the start of the turn across worker threads.
+//Built once and never changed afterwards, so the AI and UI can share it between threads without locking.
+//It describes the map as it was when built, build a new one once ships have moved.
+class TurnReachability
+{
+private:
+	std::vector<ShipMovement> m_ships;
+	std::vector<std::unique_ptr<ReachabilityMap>> m_reachability;
+	std::unordered_map<int, size_t> m_shipAtTile;
+	std::pair<int, int> m_dimensions;
+
+	TurnReachability() = default;
+public:
+	//0 threads uses as many as the hardware has
+	static std::shared_ptr<const TurnReachability> build(const PathGrid& grid, const std::vector<ShipMovement>& ships,
+		const ZoneOfControl* zoc = nullptr, unsigned int threadCount = 0);
+	//Every ship of the faction on the map, moving under the faction's zone of control
+	static std::shared_ptr<const TurnReachability> build(Map& map, faction movingFaction, unsigned int threadCount = 0);
+
+	//Returns nullptr if no ship was at the position when the cache was built
+	const ReachabilityMap* find(std::pair<int, int> position) const;
+	const std::vector<ShipMovement>& getShips() const { return m_ships; }
+	const ReachabilityMap& getReachability(size_t ship) const { return *m_reachability[ship]; }
+};
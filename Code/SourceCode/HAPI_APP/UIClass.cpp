@@ -1,10 +1,14 @@
 #include "UIClass.h"
+#include <algorithm>
+#include <math.h>
 //needs splitting out really into function wrapper
 
 // : m_screenRect({ 1280, 800 }), m_rectCollider({ 0,300,0,40 }) {}
 UIWindowTest::UIWindowTest()
 	: m_screenRect({ 1600, 900 }),
-	m_rectCollider({ 0, 300, 0, 40 })
+	m_rectCollider({ 0, 300, 0, 40 }),
+	tileClicked(false),
+	endTurnPressed(false)
 {
 	storage.push_back(HAPI_Sprites.LoadSprite("Data\\mouseCrossHair.xml"));//temp mouse cursor sprite
 	storage[storage.size() - 1]->GetColliderComp().EnablePixelPerfectCollisions(true);
@@ -15,6 +19,9 @@ UIWindowTest::UIWindowTest()
 
 void UIWindowTest::OnKeyEvent(EKeyEvent keyEvent, BYTE keyCode)
 {
+	//Presses repeat while the key is held, releases don't
+	if (keyEvent == EKeyEvent::eRelease && keyCode == HK_SPACE)
+		endTurnPressed = true;
 }
 
 void UIWindowTest::OnMouseMove(const HAPI_TMouseData& mouseData)
@@ -54,15 +61,30 @@ void UIWindowTest::HandleCollision(Sprite & sprite, Sprite & collideWith)
 	//sprite is the mouse cursor sprite
 	// collideWith is the tile
 	CollisionInfo info;
-	if (sprite.CheckCollision(collideWith, &info) && trigger == true)
+	if (trigger == true && sprite.CheckCollision(collideWith, &info))//trigger first so nothing is checked unless clicked
 	{
 		//collideWith.AdvanceToNextFrame();
 		tilePos =  std::pair<float,float> (collideWith.GetTransformComp().GetPosition().x, collideWith.GetTransformComp().GetPosition().y);
 
 		trigger = false;
+		tileClicked = true;
 	}
 }
 
+bool UIWindowTest::takeTileClicked()
+{
+	const bool clicked = tileClicked;
+	tileClicked = false;
+	return clicked;
+}
+
+bool UIWindowTest::takeEndTurn()
+{
+	const bool pressed = endTurnPressed;
+	endTurnPressed = false;
+	return pressed;
+}
+
 void UIWindowTest::OnMouseEvent(EMouseEvent mouseEvent, const HAPI_TMouseData& mouseData)
 {
 	if (mouseEvent == EMouseEvent::eLeftButtonDown)
@@ -78,8 +100,10 @@ void UIWindowTest::OnMouseEvent(EMouseEvent mouseEvent, const HAPI_TMouseData& m
 	}
 	else if (mouseEvent == EMouseEvent::eWheelBack)
 	{
-		cameraZoom -= 0.1f;
+		cameraZoom = std::max(0.1f, cameraZoom - 0.1f);
 	}
+	//kept to exact steps so each zoom level is the same scale every time and its scaled tiles can be reused
+	cameraZoom = roundf(cameraZoom * 10.0f) / 10.0f;
 }
 
 void UIWindowTest::Update()
@@ -87,11 +111,6 @@ void UIWindowTest::Update()
 	//HAPI_Sprites.SetShowCursor(false);
 	storage[storage.size() - 1]->GetTransformComp().SetPosition({ (float)mouseX - 5,(float)mouseY - 5 });//this is the mouse cursor
 
-	for (int x = 0; x < storage.size(); x++)
-	{
-		storage[x]->Render(SCREEN_SURFACE);
-	}
-
 	//camera pan
 	if (!pendingCameraMovement.IsZero())
 	{
@@ -137,4 +156,12 @@ void UIWindowTest::Update()
 			//m_stickySprite->GetTransformComp().Translate(pendingCameraMovement);
 		}
 	}
+}
+
+void UIWindowTest::Render(DrawList& drawList)
+{
+	for (int x = 0; x < storage.size(); x++)
+	{
+		drawList.add(eLayerUI, (float)x, *storage[x]);
+	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <HAPISprites_lib.h>
 #include <HAPISprites_UI.h>
+#include "DrawList.h"
 using namespace HAPISPACE;
 using namespace HAPI_UI_SPACE;
 /*
@@ -31,6 +32,8 @@ private:
 
 	//will be in a vector 
 	bool trigger = false;//used for switching
+	bool tileClicked;//a click landed on a tile, until taken
+	bool endTurnPressed;//space was released, until taken
 	int frameHeight;
 	int frameWidth;
 
@@ -47,7 +50,15 @@ public:
 	void OnMouseEvent(EMouseEvent mouseEvent, const HAPI_TMouseData& mouseData) override final;
 	void OnMouseMove(const HAPI_TMouseData& mouseData) override final;
 	void HandleCollision(Sprite& sprite, Sprite& collideWith);
+	//True once for each click that landed on a tile, straight after the HandleCollision call for that tile
+	bool takeTileClicked();
+	//True once each time space is released
+	bool takeEndTurn();
+	//Moves the cursor and camera, call before Render
 	void Update();
+	//Adds the window sprites to the UI layer, later ones on top
+	void Render(DrawList& drawList);
+	float getCameraZoom() const { return cameraZoom; }
 	int mouseX, mouseY;
 	std::pair<float,float> tilePos;// this is to get center of sprite
 	std::vector<std::unique_ptr <Sprite>>storage;
@@ -0,0 +1,25 @@
+#include "ZoneOfControl.h"
+#include "PathGrid.h"
+
+ZoneOfControl::ZoneOfControl() :
+	m_dimensions(0, 0),
+	m_controlled(),
+	m_rule(eZocEndsMovement),
+	m_extraCost(DEFAULT_EXTRA_COST)
+{
+}
+
+ZoneOfControl::ZoneOfControl(const PathGrid& grid, const std::vector<std::pair<int, int>>& enemyShips, eZocRule rule, float extraCost) :
+	m_dimensions(0, 0),
+	m_controlled(),
+	m_rule(rule),
+	m_extraCost(extraCost)
+{
+	build(grid, enemyShips);
+}
+
+void ZoneOfControl::build(const PathGrid& grid, const std::vector<std::pair<int, int>>& enemyShips)
+{
+	m_dimensions = grid.getDimensions();
+	m_controlled = grid.getTilesAdjacentTo(enemyShips);
+}
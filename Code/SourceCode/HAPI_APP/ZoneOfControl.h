@@ -0,0 +1,41 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+class PathGrid;
+
+//What happens to a ship entering a tile next to an enemy
+enum eZocRule
+{
+	eZocExtraCost,		//Entering costs extra movement
+	eZocEndsMovement	//The ship can enter but has to stop there
+};
+
+//Tiles next to enemy ships for one faction, worked out once so the searches only do a lookup per tile
+class ZoneOfControl
+{
+private:
+	std::pair<int, int> m_dimensions;
+	std::vector<bool> m_controlled;
+	eZocRule m_rule;
+	float m_extraCost;
+public:
+	static constexpr float DEFAULT_EXTRA_COST = 2.0f;
+
+	//An empty zone that controls nothing
+	ZoneOfControl();
+	ZoneOfControl(const PathGrid& grid, const std::vector<std::pair<int, int>>& enemyShips,
+		eZocRule rule = eZocEndsMovement, float extraCost = DEFAULT_EXTRA_COST);
+
+	void build(const PathGrid& grid, const std::vector<std::pair<int, int>>& enemyShips);
+	void setRule(eZocRule rule, float extraCost = DEFAULT_EXTRA_COST) { m_rule = rule; m_extraCost = extraCost; }
+	eZocRule getRule() const { return m_rule; }
+
+	//Index is a PathGrid tile index of a grid the same size as the one it was built from
+	bool isControlled(int index) const { return !m_controlled.empty() && m_controlled[index]; }
+	//Added to the cost of entering the tile
+	float getExtraCost(int index) const { return m_rule == eZocExtraCost && isControlled(index) ? m_extraCost : 0.0f; }
+	//Movement can't carry on out of this tile
+	bool stopsMovement(int index) const { return m_rule == eZocEndsMovement && isControlled(index); }
+	std::pair<int, int> getDimensions() const { return m_dimensions; }
+};
@@ -33,6 +33,8 @@ enum class faction
 	eFaction3,
 	eFaction4
 };
+//One past the last faction, for anything kept per faction
+constexpr int FACTION_COUNT = static_cast<int>(faction::eFaction4) + 1;
 
 struct weapon
 {
@@ -71,6 +73,7 @@ public:
 	void heal(int healAmount);
 	void setMovementPoints(float movementPoints);
 	float getMovementPoints() const;
+	float getMaxMovementPoints() const;
 	void setDirection(eDirection newDirection);
 	eDirection getDirection() const;
 	void setTileLocation(HAPISPACE::VectorI newTileLocation);
@@ -0,0 +1,323 @@
+//Benchmarks the pathfinding searches on generated maps. HAPI is only linked for the Map and Entity overloads in Pathfinding.cpp,
+//Map.cpp brings the terrain drawing sources in with it.
+//Every map and query comes from a fixed seed so runs on different commits do the same work.
+//
+//Usage: PathBenchmark [--max-size N] [--queries N] [--out results.csv] [--compare baseline.csv]
+//Results are printed as CSV, --out also writes them to a file and --compare prints the change from an earlier file.
+//peak_mb is the peak memory of the whole process so far, so it only ever grows down the table.
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "FlowField.h"
+#include "PathGrid.h"
+#include "Pathfinding.h"
+
+namespace
+{
+	const int MAP_SIZES[] = { 32, 128, 512, 1024, 4096 };
+	const char* MAP_KINDS[] = { "ocean", "archipelago", "maze" };
+
+	struct BenchmarkResult
+	{
+		std::string m_map;
+		int m_size;
+		std::string m_workload;
+		int m_queries;
+		unsigned long long m_expanded;
+		double m_nsPerExpansion;
+		double m_queriesPerSecond;
+		double m_peakMegabytes;
+
+		std::string getKey() const { return m_map + "," + std::to_string(m_size) + "," + m_workload; }
+	};
+
+	double getPeakMegabytes()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+		return 0.0;
+#else
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_maxrss / 1024.0;
+#endif
+	}
+
+	//Random islands grown until about a quarter of the map is land
+	void makeArchipelago(PathGrid& grid, std::mt19937& random)
+	{
+		const int landTarget = grid.getSize() / 4;
+		const int islandSize = std::max(4, grid.getSize() / 400);
+		int land = 0;
+		while (land < landTarget)
+		{
+			int index = random() % grid.getSize();
+			for (int step = 0; step < islandSize; step++)
+			{
+				if (grid.isNavigable(index))
+				{
+					grid.setType(index, eGrass);
+					land++;
+				}
+				const int next = grid.getAdjacentIndex(index, random() % 6);
+				if (next != -1)
+					index = next;
+			}
+		}
+	}
+
+	//Rooms eight tiles across with walls between them, each wall has a couple of gaps
+	void makeMaze(PathGrid& grid, std::mt19937& random)
+	{
+		const int room = 8;
+		const std::pair<int, int> dimensions = grid.getDimensions();
+		for (int y = room; y < dimensions.second; y += room)
+		{
+			for (int x = 0; x < dimensions.first; x++)
+				grid.setType(grid.getIndex({ x, y }), eGrass);
+			for (int x = 0; x < dimensions.first; x += room)
+			{
+				const int gap = x + random() % (room - 1);
+				if (gap < dimensions.first)
+					grid.setType(grid.getIndex({ gap, y }), eSea);
+			}
+		}
+		for (int x = room; x < dimensions.first; x += room)
+		{
+			for (int y = 0; y < dimensions.second; y++)
+			{
+				if (y % room != 0)
+					grid.setType(grid.getIndex({ x, y }), eGrass);
+			}
+			for (int y = 0; y < dimensions.second; y += room)
+			{
+				const int gap = y + 1 + random() % (room - 1);
+				if (gap < dimensions.second)
+					grid.setType(grid.getIndex({ x, gap }), eSea);
+			}
+		}
+	}
+
+	PathGrid makeMap(const std::string& kind, int size)
+	{
+		PathGrid grid({ size, size }, eSea);
+		std::mt19937 random(size);
+		if (kind == "archipelago")
+			makeArchipelago(grid, random);
+		else if (kind == "maze")
+			makeMaze(grid, random);
+		return grid;
+	}
+
+	std::pair<int, int> getOpenTile(const PathGrid& grid, std::mt19937& random)
+	{
+		while (true)
+		{
+			const int index = random() % grid.getSize();
+			if (grid.isPassable(index))
+				return grid.getCoordinate(index);
+		}
+	}
+
+	//Fewer queries on big maps so each size takes roughly as long
+	int getQueryCount(int baseQueries, int size)
+	{
+		const long long scaled = static_cast<long long>(baseQueries) * 128 * 128 / (static_cast<long long>(size) * size);
+		return static_cast<int>(std::max(4LL, std::min(static_cast<long long>(baseQueries), scaled)));
+	}
+
+	BenchmarkResult makeResult(const std::string& kind, int size, const std::string& workload, int queries,
+		unsigned long long expanded, std::chrono::steady_clock::duration elapsed)
+	{
+		const double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		BenchmarkResult result;
+		result.m_map = kind;
+		result.m_size = size;
+		result.m_workload = workload;
+		result.m_queries = queries;
+		result.m_expanded = expanded;
+		result.m_nsPerExpansion = expanded > 0 ? nanoseconds / expanded : 0.0;
+		result.m_queriesPerSecond = nanoseconds > 0.0 ? queries * 1e9 / nanoseconds : 0.0;
+		result.m_peakMegabytes = getPeakMegabytes();
+		return result;
+	}
+
+	BenchmarkResult runAStar(const PathGrid& grid, const std::string& kind, int size, int queries)
+	{
+		Pathfinding pathfinding;
+		std::mt19937 random(size * 3 + 1);
+		unsigned long long expanded = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int query = 0; query < queries; query++)
+		{
+			const std::pair<int, int> src = getOpenTile(grid, random);
+			const std::pair<int, int> dest = getOpenTile(grid, random);
+			pathfinding.findPath(grid, src, dest);
+			expanded += pathfinding.getLastExpansions();
+		}
+		return makeResult(kind, size, "astar", queries, expanded, std::chrono::steady_clock::now() - start);
+	}
+
+	BenchmarkResult runReachability(const PathGrid& grid, const std::string& kind, int size, int queries, float movementPoints)
+	{
+		Pathfinding pathfinding;
+		std::mt19937 random(size * 5 + 2);
+		unsigned long long expanded = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int query = 0; query < queries; query++)
+		{
+			pathfinding.findAvailableTiles(grid, getOpenTile(grid, random), movementPoints);
+			expanded += pathfinding.getLastExpansions();
+		}
+		const std::string workload = "reach" + std::to_string(static_cast<int>(movementPoints));
+		return makeResult(kind, size, workload, queries, expanded, std::chrono::steady_clock::now() - start);
+	}
+
+	BenchmarkResult runFlowField(const PathGrid& grid, const std::string& kind, int size, int queries)
+	{
+		std::mt19937 random(size * 7 + 3);
+		unsigned long long expanded = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int query = 0; query < queries; query++)
+		{
+			const std::vector<std::pair<int, int>> goals(1, getOpenTile(grid, random));
+			FlowField field(grid, goals);
+			expanded += field.getExpansions();
+		}
+		return makeResult(kind, size, "flowfield", queries, expanded, std::chrono::steady_clock::now() - start);
+	}
+
+	const char* CSV_HEADER = "map,size,workload,queries,expanded,ns_per_expansion,queries_per_sec,peak_mb";
+
+	std::string toCsv(const BenchmarkResult& result)
+	{
+		char line[256];
+		snprintf(line, sizeof(line), "%s,%d,%s,%d,%llu,%.2f,%.2f,%.1f", result.m_map.c_str(), result.m_size,
+			result.m_workload.c_str(), result.m_queries, result.m_expanded, result.m_nsPerExpansion,
+			result.m_queriesPerSecond, result.m_peakMegabytes);
+		return line;
+	}
+
+	std::map<std::string, BenchmarkResult> loadCsv(const std::string& filename)
+	{
+		std::map<std::string, BenchmarkResult> results;
+		std::ifstream file(filename);
+		std::string line;
+		std::getline(file, line);
+		while (std::getline(file, line))
+		{
+			std::vector<std::string> fields;
+			std::stringstream stream(line);
+			std::string field;
+			while (std::getline(stream, field, ','))
+				fields.push_back(field);
+			if (fields.size() != 8)
+				continue;
+
+			BenchmarkResult result;
+			result.m_map = fields[0];
+			result.m_size = std::atoi(fields[1].c_str());
+			result.m_workload = fields[2];
+			result.m_queries = std::atoi(fields[3].c_str());
+			result.m_expanded = std::strtoull(fields[4].c_str(), nullptr, 10);
+			result.m_nsPerExpansion = std::atof(fields[5].c_str());
+			result.m_queriesPerSecond = std::atof(fields[6].c_str());
+			result.m_peakMegabytes = std::atof(fields[7].c_str());
+			results[result.getKey()] = result;
+		}
+		return results;
+	}
+
+	double getChange(double before, double after)
+	{
+		return before != 0.0 ? (after - before) * 100.0 / before : 0.0;
+	}
+
+	void printComparison(const std::vector<BenchmarkResult>& results, const std::map<std::string, BenchmarkResult>& baseline)
+	{
+		std::cout << std::endl << "map,size,workload,expanded_change_%,ns_per_expansion_change_%,queries_per_sec_change_%" << std::endl;
+		for (const BenchmarkResult& result : results)
+		{
+			auto it = baseline.find(result.getKey());
+			if (it == baseline.end())
+			{
+				std::cout << result.getKey() << ",new,new,new" << std::endl;
+				continue;
+			}
+			char line[256];
+			snprintf(line, sizeof(line), "%s,%+.1f,%+.1f,%+.1f", result.getKey().c_str(),
+				getChange(static_cast<double>(it->second.m_expanded), static_cast<double>(result.m_expanded)),
+				getChange(it->second.m_nsPerExpansion, result.m_nsPerExpansion),
+				getChange(it->second.m_queriesPerSecond, result.m_queriesPerSecond));
+			std::cout << line << std::endl;
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int maxSize = 4096;
+	int baseQueries = 200;
+	std::string outFile;
+	std::string compareFile;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		const std::string option = argv[i];
+		if (option == "--max-size")
+			maxSize = std::atoi(argv[i + 1]);
+		else if (option == "--queries")
+			baseQueries = std::max(1, std::atoi(argv[i + 1]));
+		else if (option == "--out")
+			outFile = argv[i + 1];
+		else if (option == "--compare")
+			compareFile = argv[i + 1];
+	}
+
+	std::vector<BenchmarkResult> results;
+	std::cout << CSV_HEADER << std::endl;
+	for (int size : MAP_SIZES)
+	{
+		if (size > maxSize)
+			break;
+		const int queries = getQueryCount(baseQueries, size);
+		for (const char* kind : MAP_KINDS)
+		{
+			const PathGrid grid = makeMap(kind, size);
+			results.push_back(runAStar(grid, kind, size, queries));
+			std::cout << toCsv(results.back()) << std::endl;
+			results.push_back(runReachability(grid, kind, size, baseQueries, 8.0f));
+			std::cout << toCsv(results.back()) << std::endl;
+			results.push_back(runReachability(grid, kind, size, getQueryCount(baseQueries, 128), 32.0f));
+			std::cout << toCsv(results.back()) << std::endl;
+			results.push_back(runFlowField(grid, kind, size, std::max(1, queries / 10)));
+			std::cout << toCsv(results.back()) << std::endl;
+		}
+	}
+
+	if (!outFile.empty())
+	{
+		std::ofstream file(outFile);
+		file << CSV_HEADER << std::endl;
+		for (const BenchmarkResult& result : results)
+			file << toCsv(result) << std::endl;
+	}
+	if (!compareFile.empty())
+		printComparison(results, loadCsv(compareFile));
+	return 0;
+}